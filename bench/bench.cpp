@@ -0,0 +1,265 @@
+#include "bench.h"
+#include "circbuf.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+template <std::size_t Bytes>
+struct Payload
+{
+    Payload() = default;
+
+    explicit Payload(const std::size_t value)
+    {
+        data.fill(static_cast<unsigned char>(value));
+    }
+
+    friend bool
+    operator==(const Payload&, const Payload&) = default;
+
+    friend auto
+    operator<=>(const Payload&, const Payload&) = default;
+
+    std::array<unsigned char, Bytes> data{};
+};
+
+template <typename T>
+T
+make_value(const std::size_t value)
+{
+    if constexpr (std::is_arithmetic_v<T>)
+    {
+        return static_cast<T>(value);
+    }
+    else
+    {
+        return T{value};
+    }
+}
+
+template <typename T>
+std::string
+type_name()
+{
+    return std::to_string(sizeof(T)) + "B";
+}
+
+template <typename T, std::size_t N>
+std::shared_ptr<circbuf::CircularBuffer<T, N>>
+make_full_buffer()
+{
+    auto cb = std::make_shared<circbuf::CircularBuffer<T, N>>();
+    // wrap the buffer so that traversals cross the physical end
+    for (std::size_t i = 0; i < N + N / 2; ++i)
+    {
+        cb->push_back(make_value<T>(i));
+    }
+    return cb;
+}
+
+template <typename T, std::size_t N>
+void
+add_benchmarks(bench::Runner& runner)
+{
+    using Buf = circbuf::CircularBuffer<T, N>;
+    const auto suffix = "/" + type_name<T>() + "/" + std::to_string(N);
+
+    runner.add("push_back" + suffix, N, [cb = make_full_buffer<T, N>()] {
+        for (std::size_t i = 0; i < N; ++i)
+        {
+            cb->push_back(make_value<T>(i));
+        }
+        bench::do_not_optimize(cb->back());
+    });
+
+    runner.add("push_back_pop_front" + suffix,
+               N,
+               [cb = std::make_shared<Buf>()] {
+                   for (std::size_t i = 0; i < N; ++i)
+                   {
+                       cb->push_back(make_value<T>(i));
+                   }
+                   for (std::size_t i = 0; i < N; ++i)
+                   {
+                       bench::do_not_optimize(cb->pop_front());
+                   }
+               });
+
+    runner.add("iterate" + suffix, N, [cb = make_full_buffer<T, N>()] {
+        std::size_t count{};
+        for (const auto& value : *cb)
+        {
+            count += reinterpret_cast<const unsigned char&>(value);
+        }
+        bench::do_not_optimize(count);
+    });
+
+    runner.add("index_modulo" + suffix, N, [cb = make_full_buffer<T, N>()] {
+        std::size_t count{};
+        for (std::size_t i = 0; i < cb->size(); ++i)
+        {
+            count += reinterpret_cast<const unsigned char&>((*cb)[i]);
+        }
+        bench::do_not_optimize(count);
+    });
+
+    std::vector<std::size_t> indices(4096);
+    std::mt19937 engine{42};
+    std::uniform_int_distribution<std::size_t> distribution{0, N - 1};
+    for (auto& index : indices)
+    {
+        index = distribution(engine);
+    }
+    runner.add("random_access" + suffix,
+               indices.size(),
+               [cb = make_full_buffer<T, N>(), indices] {
+                   std::size_t count{};
+                   for (const auto index : indices)
+                   {
+                       count +=
+                           reinterpret_cast<const unsigned char&>((*cb)[index]);
+                   }
+                   bench::do_not_optimize(count);
+               });
+
+    if constexpr (std::is_arithmetic_v<T>)
+    {
+        // the full buffer holds N + N / 2 - N ... N + N / 2 - 1 in order
+        runner.add("lower_bound" + suffix,
+                   indices.size(),
+                   [cb = make_full_buffer<T, N>(), indices] {
+                       std::size_t count{};
+                       for (const auto index : indices)
+                       {
+                           const auto value = make_value<T>(N / 2 + index);
+                           count += static_cast<std::size_t>(
+                               std::lower_bound(cb->begin(), cb->end(), value) -
+                               cb->begin());
+                       }
+                       bench::do_not_optimize(count);
+                   });
+
+        auto bytes = std::make_shared<std::vector<std::byte>>();
+        runner.add("serialize" + suffix,
+                   N,
+                   [cb = make_full_buffer<T, N>(), bytes] {
+                       bytes->clear();
+                       cb->serialize([&](const std::span<const std::byte> in) {
+                           bytes->insert(bytes->end(), in.begin(), in.end());
+                       });
+                       bench::do_not_optimize(bytes->size());
+                   });
+        make_full_buffer<T, N>()->serialize(
+            [&](const std::span<const std::byte> in) {
+                bytes->insert(bytes->end(), in.begin(), in.end());
+            });
+        runner.add("deserialize" + suffix,
+                   N,
+                   [cb = std::make_shared<Buf>(), bytes] {
+                       std::size_t position{};
+                       cb->deserialize([&](const std::span<std::byte> out) {
+                           std::copy_n(bytes->data() + position,
+                                       out.size(),
+                                       out.data());
+                           position += out.size();
+                           return true;
+                       });
+                       bench::do_not_optimize(cb->back());
+                   });
+    }
+
+    runner.add("copy" + suffix, N, [cb = make_full_buffer<T, N>()] {
+        auto copy = std::make_unique<Buf>(*cb);
+        bench::do_not_optimize(copy->back());
+    });
+
+    runner.add("move" + suffix, 2 * N, [cb = make_full_buffer<T, N>()] {
+        auto moved = std::make_unique<Buf>(std::move(*cb));
+        *cb = std::move(*moved);
+        bench::do_not_optimize(cb->back());
+    });
+
+    auto lhs = make_full_buffer<T, N>();
+    auto rhs = make_full_buffer<T, N>();
+    runner.add("compare" + suffix, N, [lhs, rhs] {
+        bench::do_not_optimize(*lhs == *rhs);
+    });
+}
+
+// Strings long enough to live on the heap, to show the cost of destroying
+// popped elements and of clearing a sparsely filled buffer.
+void
+add_string_benchmarks(bench::Runner& runner)
+{
+    constexpr std::size_t N = 65536;
+    constexpr std::size_t few = 64;
+    using Buf = circbuf::CircularBuffer<std::string, N>;
+    const std::string value(64, 'x');
+
+    runner.add("push_back_pop_front/string/65536",
+               N,
+               [cb = std::make_shared<Buf>(), value] {
+                   for (std::size_t i = 0; i < N; ++i)
+                   {
+                       cb->push_back(value);
+                   }
+                   for (std::size_t i = 0; i < N; ++i)
+                   {
+                       bench::do_not_optimize(cb->pop_front());
+                   }
+               });
+
+    runner.add(
+        "clear_full/string/65536", N, [cb = std::make_shared<Buf>(), value] {
+            for (std::size_t i = 0; i < N; ++i)
+            {
+                cb->push_back(value);
+            }
+            cb->clear();
+        });
+
+    runner.add(
+        "clear_few/string/65536", few, [cb = std::make_shared<Buf>(), value] {
+            for (std::size_t i = 0; i < few; ++i)
+            {
+                cb->push_back(value);
+            }
+            cb->clear();
+        });
+}
+
+template <typename T>
+void
+add_capacities(bench::Runner& runner)
+{
+    add_benchmarks<T, 1000>(runner);
+    add_benchmarks<T, 1024>(runner);
+    add_benchmarks<T, 65000>(runner);
+    add_benchmarks<T, 65536>(runner);
+}
+
+} // namespace
+
+int
+main(int argc, char** argv)
+{
+    bench::Runner runner{argc, argv};
+    if (!runner.valid())
+    {
+        return 1;
+    }
+    add_capacities<int>(runner);
+    add_capacities<Payload<16>>(runner);
+    add_capacities<Payload<64>>(runner);
+    add_string_benchmarks(runner);
+    return runner.run();
+}
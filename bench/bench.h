@@ -0,0 +1,343 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace bench
+{
+
+// Keeps the optimizer from discarding the computation producing value.
+template <typename T>
+inline void
+do_not_optimize(const T& value)
+{
+    static volatile unsigned char sink{};
+    unsigned char byte{};
+    std::memcpy(&byte, &value, 1);
+    sink = static_cast<unsigned char>(sink + byte);
+}
+
+// Counts last-level cache misses of the calling thread via perf_event_open.
+// Unavailable (valid() == false) on other platforms or when the kernel
+// does not permit access to hardware counters.
+class CacheMissCounter
+{
+public:
+    CacheMissCounter()
+    {
+#if defined(__linux__)
+        perf_event_attr attr{};
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        m_fd = static_cast<int>(
+            syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+    }
+
+    CacheMissCounter(const CacheMissCounter&) = delete;
+    CacheMissCounter&
+    operator=(const CacheMissCounter&) = delete;
+
+    ~CacheMissCounter()
+    {
+#if defined(__linux__)
+        if (m_fd >= 0)
+        {
+            close(m_fd);
+        }
+#endif
+    }
+
+    bool
+    valid() const
+    {
+        return m_fd >= 0;
+    }
+
+    void
+    start()
+    {
+#if defined(__linux__)
+        if (valid())
+        {
+            ioctl(m_fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(m_fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    long long
+    stop()
+    {
+        long long count{-1};
+#if defined(__linux__)
+        if (valid())
+        {
+            ioctl(m_fd, PERF_EVENT_IOC_DISABLE, 0);
+            if (read(m_fd, &count, sizeof(count)) != sizeof(count))
+            {
+                count = -1;
+            }
+        }
+#endif
+        return count;
+    }
+
+private:
+    int m_fd{-1};
+};
+
+struct Result
+{
+    std::string name;
+    std::size_t iterations{};
+    double ns_per_op{};
+    // negative when not measured
+    double cache_misses_per_op{-1};
+    long long footprint_bytes{-1};
+};
+
+// A minimal benchmark runner. Each benchmark runs a batch of operations per
+// call; calls are repeated until a minimum duration is reached and the
+// fastest repetition is reported. Results are printed as a table and can be
+// written as JSON in the layout produced by Google Benchmark so that the
+// usual tracking tools can consume them.
+class Runner
+{
+public:
+    explicit Runner(int argc, char** argv)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string arg{argv[i]};
+            if (arg == "--json" && i + 1 < argc)
+            {
+                m_json_path = argv[++i];
+            }
+            else if (arg == "--filter" && i + 1 < argc)
+            {
+                m_filter = argv[++i];
+            }
+            else if (arg == "--min-time-ms" && i + 1 < argc)
+            {
+                m_min_time = std::chrono::milliseconds{std::stol(argv[++i])};
+            }
+            else
+            {
+                std::fprintf(stderr,
+                             "usage: %s [--json <file>] [--filter <substring>] "
+                             "[--min-time-ms <ms>]\n",
+                             argv[0]);
+                m_valid = false;
+            }
+        }
+    }
+
+    bool
+    valid() const
+    {
+        return m_valid;
+    }
+
+    // Registers a benchmark whose function performs operations operations
+    // per call.
+    void
+    add(std::string name,
+        const std::size_t operations,
+        std::function<void()> function)
+    {
+        if (name.find(m_filter) == std::string::npos)
+        {
+            return;
+        }
+        m_benchmarks.push_back(
+            {std::move(name), operations, std::move(function), {}});
+    }
+
+    // Registers a benchmark that additionally reports the memory footprint
+    // in bytes as returned by footprint after the benchmark has run.
+    void
+    add(std::string name,
+        const std::size_t operations,
+        std::function<void()> function,
+        std::function<std::size_t()> footprint)
+    {
+        if (name.find(m_filter) == std::string::npos)
+        {
+            return;
+        }
+        m_benchmarks.push_back({std::move(name),
+                                operations,
+                                std::move(function),
+                                std::move(footprint)});
+    }
+
+    // Enables cache miss counting if the platform supports it.
+    void
+    count_cache_misses()
+    {
+        m_cache_misses = std::make_unique<CacheMissCounter>();
+        if (!m_cache_misses->valid())
+        {
+            std::fprintf(stderr, "cache miss counters are unavailable\n");
+            m_cache_misses.reset();
+        }
+    }
+
+    int
+    run()
+    {
+        std::vector<Result> results;
+        for (auto& benchmark : m_benchmarks)
+        {
+            results.push_back(measure(benchmark));
+            const auto& result = results.back();
+            std::printf(
+                "%-56s %12.3f ns/op", result.name.c_str(), result.ns_per_op);
+            if (result.cache_misses_per_op >= 0)
+            {
+                std::printf(
+                    " %10.4f misses/op", result.cache_misses_per_op);
+            }
+            if (result.footprint_bytes >= 0)
+            {
+                std::printf(" %10lld bytes", result.footprint_bytes);
+            }
+            std::printf("\n");
+            std::fflush(stdout);
+        }
+        if (!m_json_path.empty())
+        {
+            return write_json(results) ? 0 : 1;
+        }
+        return 0;
+    }
+
+private:
+    struct Benchmark
+    {
+        std::string name;
+        std::size_t operations;
+        std::function<void()> function;
+        std::function<std::size_t()> footprint;
+    };
+
+    Result
+    measure(Benchmark& benchmark) const
+    {
+        using Clock = std::chrono::steady_clock;
+        benchmark.function(); // warm-up
+        double best = std::numeric_limits<double>::max();
+        std::size_t calls{};
+        const auto deadline = Clock::now() + m_min_time;
+        do
+        {
+            const auto start = Clock::now();
+            benchmark.function();
+            const auto stop = Clock::now();
+            best = std::min(
+                best,
+                std::chrono::duration<double, std::nano>(stop - start).count());
+            ++calls;
+        } while (Clock::now() < deadline || calls < 3);
+        Result result{benchmark.name,
+                      calls * benchmark.operations,
+                      best / static_cast<double>(benchmark.operations)};
+        if (m_cache_misses)
+        {
+            m_cache_misses->start();
+            benchmark.function();
+            const auto misses = m_cache_misses->stop();
+            if (misses >= 0)
+            {
+                result.cache_misses_per_op = static_cast<double>(misses) /
+                    static_cast<double>(benchmark.operations);
+            }
+        }
+        if (benchmark.footprint)
+        {
+            result.footprint_bytes =
+                static_cast<long long>(benchmark.footprint());
+        }
+        return result;
+    }
+
+    bool
+    write_json(const std::vector<Result>& results) const
+    {
+        auto file = std::fopen(m_json_path.c_str(), "w");
+        if (!file)
+        {
+            std::fprintf(stderr, "cannot open %s\n", m_json_path.c_str());
+            return false;
+        }
+        char date[32]{};
+        const auto now = std::time(nullptr);
+        std::strftime(
+            date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::gmtime(&now));
+        std::fprintf(file, "{\n  \"context\": {\n");
+        std::fprintf(file, "    \"date\": \"%s\",\n", date);
+#ifdef NDEBUG
+        std::fprintf(file, "    \"library_build_type\": \"release\"\n");
+#else
+        std::fprintf(file, "    \"library_build_type\": \"debug\"\n");
+#endif
+        std::fprintf(file, "  },\n  \"benchmarks\": [\n");
+        for (std::size_t i = 0; i < results.size(); ++i)
+        {
+            const auto& result = results[i];
+            std::fprintf(file,
+                         "    {\"name\": \"%s\", \"run_type\": \"iteration\", "
+                         "\"iterations\": %zu, \"real_time\": %.4f, "
+                         "\"cpu_time\": %.4f, \"time_unit\": \"ns\"",
+                         result.name.c_str(),
+                         result.iterations,
+                         result.ns_per_op,
+                         result.ns_per_op);
+            if (result.cache_misses_per_op >= 0)
+            {
+                std::fprintf(file,
+                             ", \"cache_misses_per_op\": %.6f",
+                             result.cache_misses_per_op);
+            }
+            if (result.footprint_bytes >= 0)
+            {
+                std::fprintf(
+                    file, ", \"footprint_bytes\": %lld", result.footprint_bytes);
+            }
+            std::fprintf(file, "}%s\n", i + 1 < results.size() ? "," : "");
+        }
+        std::fprintf(file, "  ]\n}\n");
+        std::fclose(file);
+        return true;
+    }
+
+    std::vector<Benchmark> m_benchmarks;
+    std::string m_json_path;
+    std::string m_filter;
+    std::chrono::milliseconds m_min_time{100};
+    std::unique_ptr<CacheMissCounter> m_cache_misses;
+    bool m_valid{true};
+};
+
+} // namespace bench
@@ -0,0 +1,118 @@
+#include "bench.h"
+#include "circbuf_cache.h"
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <random>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Compares a ClockCache with an LRU cache made of a std::list and a
+// std::unordered_map for skewed lookups that load the value on a miss.
+
+namespace
+{
+
+constexpr std::size_t capacity = 4096;
+constexpr std::size_t lookups = 1 << 16;
+
+struct Metadata
+{
+    std::uint64_t id;
+    double tick_size;
+    std::uint32_t lot_size;
+};
+
+Metadata
+load(const std::uint32_t id)
+{
+    return {id, 0.01, 100};
+}
+
+class LruCache
+{
+public:
+    const Metadata&
+    get(const std::uint32_t key)
+    {
+        const auto found = m_index.find(key);
+        if (found != m_index.end())
+        {
+            m_order.splice(m_order.begin(), m_order, found->second);
+            return found->second->second;
+        }
+        if (m_order.size() == capacity)
+        {
+            m_index.erase(m_order.back().first);
+            m_order.pop_back();
+        }
+        m_order.emplace_front(key, load(key));
+        m_index.emplace(key, m_order.begin());
+        return m_order.front().second;
+    }
+
+private:
+    using Order = std::list<std::pair<std::uint32_t, Metadata>>;
+    Order m_order;
+    std::unordered_map<std::uint32_t, Order::iterator> m_index;
+};
+
+using Clock = circbuf::ClockCache<std::uint32_t, Metadata, capacity>;
+
+std::vector<std::uint32_t>
+skewed_keys()
+{
+    std::mt19937 engine{42};
+    std::geometric_distribution<std::uint32_t> distribution{0.0002};
+    std::vector<std::uint32_t> result(lookups);
+    for (auto& key : result)
+    {
+        key = distribution(engine);
+    }
+    return result;
+}
+
+} // namespace
+
+int
+main(int argc, char** argv)
+{
+    bench::Runner runner{argc, argv};
+    if (!runner.valid())
+    {
+        return 1;
+    }
+    const auto keys = std::make_shared<std::vector<std::uint32_t>>(
+        skewed_keys());
+
+    auto clock = std::make_shared<Clock>();
+    runner.add("lookup/clock", lookups, [clock, keys] {
+        std::uint64_t sum{};
+        for (const auto key : *keys)
+        {
+            if (const auto* metadata = clock->find(key))
+            {
+                sum += metadata->lot_size;
+            }
+            else
+            {
+                sum += clock->put(key, load(key)).lot_size;
+            }
+        }
+        bench::do_not_optimize(sum);
+    });
+
+    auto lru = std::make_shared<LruCache>();
+    runner.add("lookup/lru", lookups, [lru, keys] {
+        std::uint64_t sum{};
+        for (const auto key : *keys)
+        {
+            sum += lru->get(key).lot_size;
+        }
+        bench::do_not_optimize(sum);
+    });
+
+    return runner.run();
+}
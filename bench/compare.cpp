@@ -0,0 +1,459 @@
+#include "bench.h"
+#include "circbuf.h"
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <queue>
+#include <random>
+#include <string>
+#include <vector>
+
+// Runs identical workloads against CircularBuffer and common alternatives.
+// All competitors are either standard containers or defined in this file.
+
+namespace
+{
+
+using Value = std::uint64_t;
+constexpr std::size_t window = 1024;
+
+// Tracks the bytes currently allocated through it in an external counter.
+template <typename T>
+struct CountingAllocator
+{
+    using value_type = T;
+
+    explicit CountingAllocator(std::size_t& allocated) noexcept
+        : allocated{&allocated}
+    {
+    }
+
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U>& other) noexcept
+        : allocated{other.allocated}
+    {
+    }
+
+    T*
+    allocate(const std::size_t count)
+    {
+        *allocated += count * sizeof(T);
+        return std::allocator<T>{}.allocate(count);
+    }
+
+    void
+    deallocate(T* pointer, const std::size_t count) noexcept
+    {
+        *allocated -= count * sizeof(T);
+        std::allocator<T>{}.deallocate(pointer, count);
+    }
+
+    template <typename U>
+    friend bool
+    operator==(const CountingAllocator& lhs,
+               const CountingAllocator<U>& rhs) noexcept
+    {
+        return lhs.allocated == rhs.allocated;
+    }
+
+    std::size_t* allocated;
+};
+
+using Deque = std::deque<Value, CountingAllocator<Value>>;
+
+// A heap-allocated ring with a runtime capacity that steps raw pointers
+// and wraps them at the end of the allocation, the way
+// boost::circular_buffer does.
+class PointerRing
+{
+public:
+    explicit PointerRing(const std::size_t capacity)
+        : m_begin{new Value[capacity]}
+        , m_end{m_begin + capacity}
+        , m_first{m_begin}
+        , m_last{m_begin}
+    {
+    }
+
+    PointerRing(const PointerRing&) = delete;
+    PointerRing&
+    operator=(const PointerRing&) = delete;
+
+    ~PointerRing()
+    {
+        delete[] m_begin;
+    }
+
+    std::size_t
+    capacity() const
+    {
+        return static_cast<std::size_t>(m_end - m_begin);
+    }
+
+    bool
+    full() const
+    {
+        return m_size == capacity();
+    }
+
+    std::size_t
+    size() const
+    {
+        return m_size;
+    }
+
+    void
+    push(const Value value)
+    {
+        *m_last = value;
+        increment(m_last);
+        if (full())
+        {
+            increment(m_first);
+        }
+        else
+        {
+            ++m_size;
+        }
+    }
+
+    Value
+    pop()
+    {
+        const auto value = *m_first;
+        increment(m_first);
+        --m_size;
+        return value;
+    }
+
+    Value
+    operator[](const std::size_t index) const
+    {
+        const auto offset = static_cast<std::size_t>(m_end - m_first);
+        return index < offset ? m_first[index] : m_begin[index - offset];
+    }
+
+private:
+    void
+    increment(Value*& pointer) const
+    {
+        if (++pointer == m_end)
+        {
+            pointer = m_begin;
+        }
+    }
+
+    Value* m_begin;
+    Value* m_end;
+    Value* m_first;
+    Value* m_last;
+    std::size_t m_size{};
+};
+
+// A plain array indexed with a power-of-two mask over free-running
+// counters.
+template <std::size_t Capacity>
+    requires((Capacity & (Capacity - 1)) == 0)
+class MaskedArray
+{
+public:
+    bool
+    full() const
+    {
+        return m_write - m_read == Capacity;
+    }
+
+    std::size_t
+    size() const
+    {
+        return static_cast<std::size_t>(m_write - m_read);
+    }
+
+    void
+    push(const Value value)
+    {
+        if (full())
+        {
+            ++m_read;
+        }
+        m_data[m_write++ & (Capacity - 1)] = value;
+    }
+
+    Value
+    pop()
+    {
+        return m_data[m_read++ & (Capacity - 1)];
+    }
+
+    Value
+    operator[](const std::size_t index) const
+    {
+        return m_data[(m_read + index) & (Capacity - 1)];
+    }
+
+private:
+    std::array<Value, Capacity> m_data{};
+    std::uint64_t m_read{};
+    std::uint64_t m_write{};
+};
+
+// Adapters presenting every competitor with the same bounded FIFO
+// interface: push evicts the oldest element once window elements are held.
+
+struct CircularBufferAdapter
+{
+    static constexpr bool random_access = true;
+
+    bool
+    full() const
+    {
+        return buffer.full();
+    }
+    std::size_t
+    size() const
+    {
+        return buffer.size();
+    }
+    void
+    push(const Value value)
+    {
+        buffer.push_back(value);
+    }
+    Value
+    pop()
+    {
+        return buffer.pop_front();
+    }
+    Value
+    operator[](const std::size_t index) const
+    {
+        return buffer[index];
+    }
+    std::size_t
+    footprint() const
+    {
+        return sizeof(*this);
+    }
+
+    circbuf::CircularBuffer<Value, window> buffer;
+};
+
+struct DequeAdapter
+{
+    static constexpr bool random_access = true;
+
+    bool
+    full() const
+    {
+        return deque.size() == window;
+    }
+    std::size_t
+    size() const
+    {
+        return deque.size();
+    }
+    void
+    push(const Value value)
+    {
+        if (full())
+        {
+            deque.pop_front();
+        }
+        deque.push_back(value);
+    }
+    Value
+    pop()
+    {
+        const auto value = deque.front();
+        deque.pop_front();
+        return value;
+    }
+    Value
+    operator[](const std::size_t index) const
+    {
+        return deque[index];
+    }
+    std::size_t
+    footprint() const
+    {
+        return sizeof(*this) + allocated;
+    }
+
+    std::size_t allocated{};
+    Deque deque{CountingAllocator<Value>{allocated}};
+};
+
+struct QueueAdapter
+{
+    static constexpr bool random_access = false;
+
+    bool
+    full() const
+    {
+        return queue.size() == window;
+    }
+    std::size_t
+    size() const
+    {
+        return queue.size();
+    }
+    void
+    push(const Value value)
+    {
+        if (full())
+        {
+            queue.pop();
+        }
+        queue.push(value);
+    }
+    Value
+    pop()
+    {
+        const auto value = queue.front();
+        queue.pop();
+        return value;
+    }
+    std::size_t
+    footprint() const
+    {
+        return sizeof(*this) + allocated;
+    }
+
+    std::size_t allocated{};
+    std::queue<Value, Deque> queue{Deque{CountingAllocator<Value>{allocated}}};
+};
+
+struct PointerRingAdapter : PointerRing
+{
+    static constexpr bool random_access = true;
+
+    PointerRingAdapter()
+        : PointerRing{window}
+    {
+    }
+    std::size_t
+    footprint() const
+    {
+        return sizeof(*this) + capacity() * sizeof(Value);
+    }
+};
+
+struct MaskedArrayAdapter : MaskedArray<window>
+{
+    static constexpr bool random_access = true;
+
+    std::size_t
+    footprint() const
+    {
+        return sizeof(*this);
+    }
+};
+
+template <typename Container>
+void
+add_workloads(bench::Runner& runner, const std::string& name)
+{
+    constexpr std::size_t operations = 1 << 16;
+
+    auto fifo = std::make_shared<Container>();
+    runner.add(
+        "fifo_streaming/" + name,
+        operations,
+        [fifo] {
+            Value sum{};
+            for (std::size_t i = 0; i < operations; ++i)
+            {
+                fifo->push(i);
+                if (fifo->size() == window / 2)
+                {
+                    for (std::size_t j = 0; j < window / 4; ++j)
+                    {
+                        sum += fifo->pop();
+                    }
+                }
+            }
+            bench::do_not_optimize(sum);
+        },
+        [fifo] { return fifo->footprint(); });
+
+    auto rolling = std::make_shared<Container>();
+    runner.add(
+        "rolling_window/" + name,
+        operations,
+        [rolling] {
+            Value sum{};
+            for (std::size_t i = 0; i < operations; ++i)
+            {
+                if (rolling->full())
+                {
+                    sum -= rolling->pop();
+                }
+                rolling->push(i);
+                sum += i;
+            }
+            bench::do_not_optimize(sum);
+        },
+        [rolling] { return rolling->footprint(); });
+
+    if constexpr (Container::random_access)
+    {
+        auto random = std::make_shared<Container>();
+        for (std::size_t i = 0; i < window + window / 2; ++i)
+        {
+            random->push(i);
+        }
+        auto indices = std::make_shared<std::vector<std::size_t>>(operations);
+        std::mt19937 engine{42};
+        std::uniform_int_distribution<std::size_t> distribution{0,
+                                                                window - 1};
+        for (auto& index : *indices)
+        {
+            index = distribution(engine);
+        }
+        runner.add(
+            "random_access/" + name,
+            operations,
+            [random, indices] {
+                Value sum{};
+                for (const auto index : *indices)
+                {
+                    sum += (*random)[index];
+                }
+                bench::do_not_optimize(sum);
+            },
+            [random] { return random->footprint(); });
+    }
+
+    auto bulk = std::make_shared<Container>();
+    runner.add(
+        "bulk_ingest/" + name,
+        operations,
+        [bulk] {
+            for (std::size_t i = 0; i < operations; ++i)
+            {
+                bulk->push(i);
+            }
+            bench::do_not_optimize(bulk->size());
+        },
+        [bulk] { return bulk->footprint(); });
+}
+
+} // namespace
+
+int
+main(int argc, char** argv)
+{
+    bench::Runner runner{argc, argv};
+    if (!runner.valid())
+    {
+        return 1;
+    }
+    runner.count_cache_misses();
+    add_workloads<CircularBufferAdapter>(runner, "CircularBuffer");
+    add_workloads<DequeAdapter>(runner, "std::deque");
+    add_workloads<QueueAdapter>(runner, "std::queue");
+    add_workloads<PointerRingAdapter>(runner, "pointer_ring");
+    add_workloads<MaskedArrayAdapter>(runner, "masked_array");
+    return runner.run();
+}
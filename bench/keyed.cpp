@@ -0,0 +1,104 @@
+#include "bench.h"
+#include "circbuf_keyed.h"
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Compares a KeyedCircularBuffer with an unordered_map of CircularBuffers,
+// one ring per key, for random pushes and for a scan summing the newest
+// value of every key.
+
+namespace
+{
+
+struct Trade
+{
+    double price;
+    std::uint64_t volume;
+};
+
+constexpr std::size_t history = 64;
+constexpr std::size_t pushes = 1 << 16;
+
+using Keyed = circbuf::KeyedCircularBuffer<std::uint32_t, Trade, history>;
+using Map =
+    std::unordered_map<std::uint32_t, circbuf::CircularBuffer<Trade, history>>;
+
+std::vector<std::uint32_t>
+random_keys(const std::uint32_t keys)
+{
+    std::mt19937 engine{42};
+    std::uniform_int_distribution<std::uint32_t> distribution{0, keys - 1};
+    std::vector<std::uint32_t> result(pushes);
+    for (auto& key : result)
+    {
+        key = distribution(engine);
+    }
+    return result;
+}
+
+void
+add_keys(bench::Runner& runner, const std::uint32_t keys)
+{
+    const auto suffix = "/keys:" + std::to_string(keys);
+    const auto order = std::make_shared<std::vector<std::uint32_t>>(
+        random_keys(keys));
+
+    auto keyed = std::make_shared<Keyed>(keys);
+    auto map = std::make_shared<Map>();
+    for (std::uint32_t key = 0; key < keys; ++key)
+    {
+        keyed->push(key, Trade{1.0, key});
+        (*map)[key].push_back(Trade{1.0, key});
+    }
+
+    runner.add("push/keyed" + suffix, pushes, [keyed, order] {
+        for (const auto key : *order)
+        {
+            keyed->push(key, Trade{2.0, key});
+        }
+    });
+    runner.add("push/map" + suffix, pushes, [map, order] {
+        for (const auto key : *order)
+        {
+            (*map)[key].push_back(Trade{2.0, key});
+        }
+    });
+
+    runner.add("scan/keyed" + suffix, keys, [keyed] {
+        std::uint64_t sum{};
+        keyed->for_each([&sum](std::uint32_t, const auto& trades) {
+            sum += trades.back().volume;
+        });
+        bench::do_not_optimize(sum);
+    });
+    runner.add("scan/map" + suffix, keys, [map] {
+        std::uint64_t sum{};
+        for (const auto& [key, trades] : *map)
+        {
+            sum += trades.back().volume;
+        }
+        bench::do_not_optimize(sum);
+    });
+}
+
+} // namespace
+
+int
+main(int argc, char** argv)
+{
+    bench::Runner runner{argc, argv};
+    if (!runner.valid())
+    {
+        return 1;
+    }
+    for (const std::uint32_t keys : {1000, 50000})
+    {
+        add_keys(runner, keys);
+    }
+    return runner.run();
+}
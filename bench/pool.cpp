@@ -0,0 +1,80 @@
+#include "bench.h"
+#include "circbuf_pool.h"
+
+#include <array>
+#include <cstdint>
+#include <memory>
+
+// Compares recycling messages through an SpscObjectPool and an
+// MpmcObjectPool with allocating them with new and delete. A window of
+// messages is kept alive so that the allocator cannot hand back the same
+// block every time.
+
+namespace
+{
+
+struct Message
+{
+    explicit Message(const std::uint64_t id) noexcept
+        : id{id}
+    {
+    }
+
+    std::uint64_t id;
+    std::array<char, 240> payload;
+};
+
+constexpr std::size_t window = 64;
+constexpr std::size_t operations = 1 << 16;
+
+template <typename Acquire, typename Release>
+void
+recycle(Acquire acquire, Release release)
+{
+    std::array<Message*, window> live{};
+    for (std::size_t i = 0; i < operations; ++i)
+    {
+        auto& slot = live[i % window];
+        if (slot)
+        {
+            release(slot);
+        }
+        slot = acquire(i);
+        bench::do_not_optimize(slot);
+    }
+    for (auto* message : live)
+    {
+        release(message);
+    }
+}
+
+} // namespace
+
+int
+main(int argc, char** argv)
+{
+    bench::Runner runner{argc, argv};
+    if (!runner.valid())
+    {
+        return 1;
+    }
+
+    runner.add("recycle/new_delete", operations, [] {
+        recycle([](const std::uint64_t id) { return new Message{id}; },
+                [](Message* message) { delete message; });
+    });
+
+    auto spsc = std::make_shared<circbuf::SpscObjectPool<Message, window>>();
+    runner.add("recycle/spsc_pool", operations, [spsc] {
+        recycle([&](const std::uint64_t id) { return spsc->acquire(id); },
+                [&](Message* message) { spsc->release(message); });
+    });
+
+    auto mpmc = std::make_shared<circbuf::MpmcObjectPool<Message, window>>();
+    runner.add("recycle/mpmc_pool", operations, [mpmc] {
+        recycle([&](const std::uint64_t id) { return mpmc->acquire(id); },
+                [&](Message* message) { mpmc->release(message); });
+    });
+
+    return runner.run();
+}
@@ -0,0 +1,112 @@
+#include "bench.h"
+#include "circbuf_sharded.h"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Measures concurrent pushes from 1 to 64 threads into a
+// ShardedCircularBuffer against a single mutex-guarded CircularBuffer, and
+// merging a snapshot of all shards. Thread start-up is part of every
+// measurement, so the operation counts are large enough to amortize it.
+
+namespace
+{
+
+struct Sample
+{
+    std::uint64_t time;
+    std::uint64_t value;
+};
+
+constexpr std::size_t capacity = 4096;
+constexpr std::size_t shards = 64;
+constexpr std::size_t operations = 1 << 20;
+
+using Sharded = circbuf::ShardedCircularBuffer<Sample, capacity, shards>;
+
+struct Locked
+{
+    void
+    push_back(const Sample& sample)
+    {
+        std::lock_guard lock{mutex};
+        buffer.push_back(sample);
+    }
+
+    std::mutex mutex;
+    circbuf::CircularBuffer<Sample, capacity * shards> buffer;
+};
+
+template <typename Buffer>
+void
+push_concurrently(Buffer& buffer, const std::size_t threads)
+{
+    std::vector<std::thread> writers;
+    writers.reserve(threads);
+    for (std::size_t t = 0; t < threads; ++t)
+    {
+        writers.emplace_back([&buffer, threads] {
+            for (std::size_t i = 0; i < operations / threads; ++i)
+            {
+                buffer.push_back(Sample{i, i});
+            }
+        });
+    }
+    for (auto& writer : writers)
+    {
+        writer.join();
+    }
+}
+
+} // namespace
+
+int
+main(int argc, char** argv)
+{
+    bench::Runner runner{argc, argv};
+    if (!runner.valid())
+    {
+        return 1;
+    }
+    for (std::size_t threads = 1; threads <= 64; threads *= 2)
+    {
+        const auto suffix = "/threads:" + std::to_string(threads);
+        auto sharded = std::make_shared<Sharded>();
+        runner.add(
+            "push/ShardedCircularBuffer" + suffix,
+            operations,
+            [sharded, threads] { push_concurrently(*sharded, threads); });
+        auto locked = std::make_shared<Locked>();
+        runner.add("push/locked_CircularBuffer" + suffix,
+                   operations,
+                   [locked, threads] { push_concurrently(*locked, threads); });
+    }
+
+    auto filled = std::make_shared<Sharded>();
+    for (std::size_t i = 0; i < capacity * shards; ++i)
+    {
+        filled->emplace_back_to(i % shards, Sample{i, i});
+    }
+    auto snapshot = std::make_shared<Sharded::snapshot_type>();
+    runner.add("snapshot", capacity * shards, [filled, snapshot] {
+        filled->snapshot(*snapshot);
+        bench::do_not_optimize(snapshot->front().size());
+    });
+    filled->snapshot(*snapshot);
+    runner.add("merge_by_time", capacity * shards, [snapshot] {
+        auto by_time = [](const Sample& lhs, const Sample& rhs) {
+            return lhs.time < rhs.time;
+        };
+        std::uint64_t sum{};
+        for (const auto& sample : circbuf::merge(*snapshot, by_time))
+        {
+            sum += sample.value;
+        }
+        bench::do_not_optimize(sum);
+    });
+    return runner.run();
+}
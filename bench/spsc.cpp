@@ -0,0 +1,84 @@
+#include "bench.h"
+#include "circbuf_spsc.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// Compares transferring elements through a SpscCircularBuffer one at a time
+// with transferring them in batches, which pays one atomic store per batch
+// instead of one per element. Both sides run on the same thread so that the
+// cost of the queue operations is measured without cross-core traffic.
+
+namespace
+{
+
+using Value = std::uint64_t;
+using Queue = circbuf::SpscCircularBuffer<Value, 1024>;
+constexpr std::size_t operations = 1 << 16;
+
+void
+add_batch_size(bench::Runner& runner, const std::size_t batch)
+{
+    const auto suffix = "/batch:" + std::to_string(batch);
+
+    auto single = std::make_shared<Queue>();
+    runner.add("single" + suffix, operations, [single, batch] {
+        Value sum{};
+        for (std::size_t i = 0; i < operations; i += batch)
+        {
+            for (std::size_t j = 0; j < batch; ++j)
+            {
+                single->try_push(i + j);
+            }
+            for (std::size_t j = 0; j < batch; ++j)
+            {
+                sum += *single->try_pop();
+            }
+        }
+        bench::do_not_optimize(sum);
+    });
+
+    auto batched = std::make_shared<Queue>();
+    runner.add("batched" + suffix, operations, [batched, batch] {
+        Value sum{};
+        for (std::size_t i = 0; i < operations; i += batch)
+        {
+            Value value = i;
+            for (const auto segment : batched->claim(batch))
+            {
+                for (auto& slot : segment)
+                {
+                    slot = value++;
+                }
+            }
+            batched->publish(batch);
+            for (const auto segment : batched->peek_batch(batch))
+            {
+                for (const auto element : segment)
+                {
+                    sum += element;
+                }
+            }
+            batched->consume(batch);
+        }
+        bench::do_not_optimize(sum);
+    });
+}
+
+} // namespace
+
+int
+main(int argc, char** argv)
+{
+    bench::Runner runner{argc, argv};
+    if (!runner.valid())
+    {
+        return 1;
+    }
+    for (const std::size_t batch : {1, 8, 32, 64})
+    {
+        add_batch_size(runner, batch);
+    }
+    return runner.run();
+}
@@ -0,0 +1,91 @@
+#include "bench.h"
+#include "circbuf_timer.h"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <random>
+#include <utility>
+#include <vector>
+
+// Compares a TimingWheel with a std::priority_queue of (expiry, value) pairs
+// for a steady stream of timeouts: every tick schedules a few timers with
+// random delays and fires those that are due.
+
+namespace
+{
+
+constexpr std::size_t per_tick = 4;
+constexpr std::size_t ticks = 1 << 14;
+constexpr std::uint64_t max_delay = 4096;
+
+using Wheel = circbuf::TimingWheel<std::uint64_t, 64, 3, 1 << 16>;
+using Entry = std::pair<std::uint64_t, std::uint64_t>;
+using Queue =
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>>;
+
+std::vector<std::uint64_t>
+random_delays()
+{
+    std::mt19937_64 engine{42};
+    std::uniform_int_distribution<std::uint64_t> distribution{1, max_delay};
+    std::vector<std::uint64_t> result(per_tick * ticks);
+    for (auto& delay : result)
+    {
+        delay = distribution(engine);
+    }
+    return result;
+}
+
+} // namespace
+
+int
+main(int argc, char** argv)
+{
+    bench::Runner runner{argc, argv};
+    if (!runner.valid())
+    {
+        return 1;
+    }
+    const auto delays =
+        std::make_shared<std::vector<std::uint64_t>>(random_delays());
+
+    runner.add("timeouts/wheel", per_tick * ticks, [delays] {
+        auto wheel = std::make_unique<Wheel>();
+        std::uint64_t sum{};
+        std::size_t next = 0;
+        for (std::size_t tick = 0; tick < ticks; ++tick)
+        {
+            for (std::size_t i = 0; i < per_tick; ++i, ++next)
+            {
+                wheel->schedule((*delays)[next], next);
+            }
+            wheel->advance(1, [&sum](const std::uint64_t value) {
+                sum += value;
+            });
+        }
+        bench::do_not_optimize(sum);
+    });
+
+    runner.add("timeouts/priority_queue", per_tick * ticks, [delays] {
+        Queue queue;
+        std::uint64_t sum{};
+        std::size_t next = 0;
+        for (std::uint64_t now = 0; now < ticks; ++now)
+        {
+            for (std::size_t i = 0; i < per_tick; ++i, ++next)
+            {
+                queue.emplace(now + (*delays)[next], next);
+            }
+            while (!queue.empty() && queue.top().first <= now + 1)
+            {
+                sum += queue.top().second;
+                queue.pop();
+            }
+        }
+        bench::do_not_optimize(sum);
+    });
+
+    return runner.run();
+}
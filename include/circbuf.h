@@ -1,20 +1,185 @@
+#pragma once
+
+#include <algorithm>
 #include <array>
 #include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <memory>
+#include <span>
 #include <type_traits>
 #include <variant>
 
+// Checked mode validates indices, emptiness and iterators, including
+// iterators invalidated by a modification of their buffer. It is on unless
+// NDEBUG is defined; define CIRCBUF_CHECKED to 0 or 1 before including this
+// header to choose. When off, the checks compile out entirely and add
+// neither space nor time.
+//
+// The mode changes the layout and the exception specifications of the
+// types, so everything is declared in an inline namespace named after it.
+// Translation units built in different modes thus use distinct types and
+// can be linked into one program without violating the one definition
+// rule. CIRCBUF_ASSERT must be the same across a program.
+#ifndef CIRCBUF_CHECKED
+#ifdef NDEBUG
+#define CIRCBUF_CHECKED 0
+#else
+#define CIRCBUF_CHECKED 1
+#endif
+#endif
+
+#if CIRCBUF_CHECKED
+#define CIRCBUF_ABI_NAMESPACE abi_checked
+#else
+#define CIRCBUF_ABI_NAMESPACE abi_unchecked
+#endif
+
 namespace circbuf
 {
+inline namespace CIRCBUF_ABI_NAMESPACE
+{
+
+namespace detail
+{
+
+// Types that need no lifetime management are stored as plain values so that
+// element access is a plain load instead of a variant lookup.
+template <typename T>
+inline constexpr bool is_trivial_storage_v =
+    std::is_trivially_default_constructible_v<T> &&
+    std::is_trivially_copyable_v<T>;
+
+// The smallest unsigned type able to represent all values in [0, MaxSize].
+template <std::size_t MaxSize>
+using index_t = std::conditional_t<
+    MaxSize <= UINT8_MAX,
+    std::uint8_t,
+    std::conditional_t<
+        MaxSize <= UINT16_MAX,
+        std::uint16_t,
+        std::conditional_t<MaxSize <= UINT32_MAX, std::uint32_t, std::size_t>>>;
+
+// Assumed size of a cache line, used to keep concurrently written data
+// apart.
+inline constexpr std::size_t cache_line_size = 64;
+
+// Whether checked mode is on.
+inline constexpr bool checked = CIRCBUF_CHECKED;
+
+[[noreturn]] inline void
+check_failed(const char* const condition,
+             const char* const file,
+             const int line) noexcept
+{
+    std::fprintf(
+        stderr, "%s:%d: circbuf check failed: %s\n", file, line, condition);
+    std::abort();
+}
+
+// Counts the modifications of a buffer that invalidate its iterators. An
+// iterator remembers the count it was created at. Empty when unchecked.
+template <bool Checked>
+struct Generation
+{
+    constexpr void
+    bump() noexcept
+    {
+        ++value;
+    }
+
+    friend constexpr bool
+    operator==(const Generation&, const Generation&) noexcept = default;
+
+    std::uint32_t value{};
+};
+
+template <>
+struct Generation<false>
+{
+    constexpr void
+    bump() noexcept
+    {
+    }
+
+    friend constexpr bool
+    operator==(const Generation&, const Generation&) noexcept = default;
+};
+
+} // namespace detail
+
+// Checks a precondition in checked mode. By default a failed check prints
+// the condition and aborts. Define it before including this header to,
+// e.g., throw instead; functions with checks are only noexcept when
+// checked mode is off.
+#ifndef CIRCBUF_ASSERT
+#if CIRCBUF_CHECKED
+#define CIRCBUF_ASSERT(condition)                                              \
+    ((condition) ? void()                                                      \
+                 : ::circbuf::detail::check_failed(                            \
+                       #condition, __FILE__, __LINE__))
+#else
+#define CIRCBUF_ASSERT(condition) static_cast<void>(0)
+#endif
+#endif
+
+#if defined(_MSC_VER)
+#define CIRCBUF_NO_UNIQUE_ADDRESS [[msvc::no_unique_address]]
+#else
+#define CIRCBUF_NO_UNIQUE_ADDRESS [[no_unique_address]]
+#endif
+
+// The policy of a CircularBuffer is notified about modifications of the
+// buffer. Every hook is optional and only called if the policy provides it:
+//
+//   on_push(const Buffer&)      after an element was appended, inserted or
+//                               restored by deserialize
+//   on_overwrite(const Buffer&) before an append replaces the front element
+//                               of a full buffer
+//   on_evict(T&&)               with the front element of a full buffer
+//                               right before an append overwrites it
+//   on_evict_range(std::span<T>)
+//                               with a run of front elements right before
+//                               a bulk append overwrites them; preferred
+//                               over on_evict by append(first, last)
+//   on_pop(const Buffer&)       after an element was removed by pop_front,
+//                               erase_begin or erase
+//   on_clear(const Buffer&)     after the buffer was cleared
+//
+// Evicted elements may be moved from, e.g. to spill them to a secondary
+// store or to recycle their resources. Hooks must not throw nor modify the
+// buffer. Policies are copied and moved
+// along with the buffer. A policy without state and hooks, such as this
+// default one, adds neither space nor time to the buffer.
+struct DefaultPolicy
+{
+};
+
+// Leads the binary snapshot written by CircularBuffer::serialize, followed
+// by the elements in order. All values are in native byte order, so
+// snapshots are meant to be read back on the same platform.
+struct SnapshotHeader
+{
+    static constexpr std::uint32_t current_version = 1;
+
+    std::uint32_t version;
+    std::uint32_t element_size;
+    std::uint64_t capacity;
+    std::uint64_t size;
+};
 
 template <typename BufferType, bool Reverse>
 class CircularBufferIterator;
 
-template <typename T, std::size_t MaxSize>
+template <typename T, std::size_t MaxSize, typename Policy = DefaultPolicy>
     requires(MaxSize > 0)
 class CircularBuffer
 {
 public:
     using value_type = T;
+    using policy_type = Policy;
     using size_type = std::size_t;
     using difference_type = std::ptrdiff_t;
     using reference = value_type&;
@@ -34,6 +199,7 @@ public:
 
     constexpr CircularBuffer(const CircularBuffer& other) noexcept(
         std::is_nothrow_copy_constructible_v<value_type>)
+        : m_policy{other.m_policy}
     {
         copy_from(other);
     }
@@ -45,14 +211,16 @@ public:
     {
         if (this != &other)
         {
-            clear();
+            destroy_all();
             copy_from(other);
+            m_policy = other.m_policy;
         }
         return *this;
     }
 
     constexpr CircularBuffer(CircularBuffer&& other) noexcept(
         std::is_nothrow_move_constructible_v<value_type>)
+        : m_policy{std::move(other.m_policy)}
     {
         move_from(std::move(other));
     }
@@ -64,8 +232,9 @@ public:
     {
         if (this != &other)
         {
-            clear();
+            destroy_all();
             move_from(std::move(other));
+            m_policy = std::move(other.m_policy);
         }
         return *this;
     }
@@ -94,65 +263,83 @@ public:
         return m_size == MaxSize;
     }
 
+    // Destroys the elements in O(size()).
     constexpr void
     clear() noexcept(std::is_nothrow_destructible_v<value_type>)
     {
-        std::destroy(m_data.begin(), m_data.end());
-        m_size = 0;
-        m_head = 0;
-        m_tail = 0;
+        destroy_all();
+        if constexpr (requires { m_policy.on_clear(*this); })
+        {
+            m_policy.on_clear(*this);
+        }
+    }
+
+    constexpr policy_type&
+    policy() noexcept
+    {
+        return m_policy;
+    }
+
+    constexpr const policy_type&
+    policy() const noexcept
+    {
+        return m_policy;
     }
 
     constexpr reference
-    operator[](const size_type index) noexcept
+    operator[](const size_type index) noexcept(!detail::checked)
     {
-        return at((m_head + index) % MaxSize);
+        CIRCBUF_ASSERT(index < m_size);
+        return at(physical(index));
     }
 
     constexpr const_reference
-    operator[](const size_type index) const noexcept
+    operator[](const size_type index) const noexcept(!detail::checked)
     {
-        return at((m_head + index) % MaxSize);
+        CIRCBUF_ASSERT(index < m_size);
+        return at(physical(index));
     }
 
     constexpr reference
-    front() noexcept
+    front() noexcept(!detail::checked)
     {
+        CIRCBUF_ASSERT(!empty());
         return at(m_head);
     }
 
     constexpr const_reference
-    front() const noexcept
+    front() const noexcept(!detail::checked)
     {
+        CIRCBUF_ASSERT(!empty());
         return at(m_head);
     }
 
     constexpr reference
-    back() noexcept
+    back() noexcept(!detail::checked)
     {
-        return at(m_tail);
+        CIRCBUF_ASSERT(!empty());
+        return at(tail());
     }
 
     constexpr const_reference
-    back() const noexcept
+    back() const noexcept(!detail::checked)
     {
-        return at(m_tail);
+        CIRCBUF_ASSERT(!empty());
+        return at(tail());
     }
 
     constexpr void
     push_back(const value_type& value) noexcept(
         std::is_nothrow_copy_constructible_v<value_type>)
     {
-        increment();
-        m_data[m_tail].template emplace<value_type>(value);
+        push(value);
     }
 
     constexpr void
     push_back(value_type&& value) noexcept(
         std::is_nothrow_move_constructible_v<value_type>)
     {
-        increment();
-        m_data[m_tail].template emplace<value_type>(std::move(value));
+        push(std::move(value));
     }
 
     template <typename... Type>
@@ -160,21 +347,306 @@ public:
     emplace_back(Type&&... value) noexcept(
         std::is_nothrow_constructible_v<value_type>)
     {
-        increment();
-        m_data[m_tail].template emplace<value_type>(
-            std::forward<Type>(value)...);
+        push(std::forward<Type>(value)...);
+    }
+
+    // Appends the elements of [first, last) as if by repeated push_back. If
+    // the policy has on_evict_range, overwritten elements are handed to it
+    // in runs rather than one by one.
+    template <std::input_iterator Iterator,
+              std::sentinel_for<Iterator> Sentinel>
+    constexpr void
+    append(Iterator first, const Sentinel last)
+    {
+        for (; first != last && !full(); ++first)
+        {
+            place(*first);
+        }
+        if constexpr (std::forward_iterator<Iterator> &&
+                      requires(std::span<value_type> run) {
+                          m_policy.on_evict_range(run);
+                      })
+        {
+            auto remaining =
+                static_cast<size_type>(std::ranges::distance(first, last));
+            while (remaining > 0)
+            {
+                size_type run = 1;
+                if constexpr (detail::is_trivial_storage_v<value_type>)
+                {
+                    run = std::min(remaining, MaxSize - m_head);
+                }
+                for (size_type i = 0; i < run; ++i)
+                {
+                    notify_overwrite();
+                }
+                m_policy.on_evict_range(std::span<value_type>{&front(), run});
+                for (size_type i = 0; i < run; ++i, ++first)
+                {
+                    place(*first);
+                }
+                remaining -= run;
+            }
+        }
+        else
+        {
+            for (; first != last; ++first)
+            {
+                push(*first);
+            }
+        }
     }
 
+    // Removes and returns the front element. Its slot is destroyed right
+    // away rather than holding on to a moved-from value.
     constexpr value_type
     pop_front() noexcept(
-        std::is_nothrow_destructible_v<value_type>&&
-            std::is_nothrow_move_constructible_v<value_type>&&
-                std::is_nothrow_copy_constructible_v<value_type>)
+        !detail::checked && std::is_nothrow_destructible_v<value_type> &&
+        std::is_nothrow_move_constructible_v<value_type> &&
+        std::is_nothrow_copy_constructible_v<value_type>)
     {
+        CIRCBUF_ASSERT(!empty());
+        m_generation.bump();
         const auto index = m_head;
-        m_head = (m_head + 1) % MaxSize;
+        value_type value = std::move(at(index));
+        destroy(index);
+        m_head = next(m_head);
         --m_size;
-        return std::move(at(index));
+        notify_pop();
+        return value;
+    }
+
+    // Removes the first count elements, destroying them right away. count
+    // must not exceed size().
+    constexpr void
+    erase_begin(const size_type count) noexcept(
+        !detail::checked && std::is_nothrow_destructible_v<value_type>)
+    {
+        CIRCBUF_ASSERT(count <= m_size);
+        m_generation.bump();
+        for (size_type i = 0; i < count; ++i)
+        {
+            destroy(m_head);
+            m_head = next(m_head);
+            --m_size;
+            notify_pop();
+        }
+    }
+
+    // Inserts value before pos and returns an iterator to it. The elements
+    // on the shorter side of pos are shifted by one, as std::deque does. If
+    // the buffer is full, the front element is overwritten first, as by
+    // push_back. Invalidates all iterators. Inserting at begin() of a full
+    // buffer would overwrite the inserted value itself, so it leaves the
+    // buffer and its iterators untouched and returns end().
+    constexpr iterator
+    insert(const iterator pos, const value_type& value) noexcept(
+        !detail::checked && std::is_nothrow_copy_constructible_v<value_type> &&
+        std::is_nothrow_move_constructible_v<value_type> &&
+        std::is_nothrow_move_assignable_v<value_type>)
+    {
+        return insert(pos, value_type{value});
+    }
+
+    constexpr iterator
+    insert(const iterator pos, value_type&& value) noexcept(
+        !detail::checked && std::is_nothrow_move_constructible_v<value_type> &&
+        std::is_nothrow_move_assignable_v<value_type>)
+    {
+        check(pos);
+        auto index = static_cast<size_type>(pos - begin());
+        if (full() && index == 0)
+        {
+            return end();
+        }
+        m_generation.bump();
+        if (full())
+        {
+            evict_front();
+            destroy(m_head);
+            m_head = next(m_head);
+            --m_size;
+            --index;
+        }
+        if (index < m_size - index)
+        {
+            // open a slot before the front and move the leading elements
+            // down by one
+            m_head = m_head == 0 ? static_cast<index_type>(MaxSize - 1)
+                                 : static_cast<index_type>(m_head - 1);
+            ++m_size;
+            if (index == 0)
+            {
+                construct(m_head, std::move(value));
+            }
+            else
+            {
+                construct(m_head, std::move(at(physical(1))));
+                for (size_type i = 1; i < index; ++i)
+                {
+                    at(physical(i)) = std::move(at(physical(i + 1)));
+                }
+                at(physical(index)) = std::move(value);
+            }
+        }
+        else
+        {
+            // open a slot after the back and move the trailing elements up
+            // by one
+            const size_type last = m_size;
+            ++m_size;
+            if (index == last)
+            {
+                construct(tail(), std::move(value));
+            }
+            else
+            {
+                construct(tail(), std::move(at(physical(last - 1))));
+                for (size_type i = last - 1; i > index; --i)
+                {
+                    at(physical(i)) = std::move(at(physical(i - 1)));
+                }
+                at(physical(index)) = std::move(value);
+            }
+        }
+        if constexpr (requires { m_policy.on_push(*this); })
+        {
+            m_policy.on_push(*this);
+        }
+        return iterator{*this, index};
+    }
+
+    // Removes the element at pos and returns an iterator to the element
+    // following it.
+    constexpr iterator
+    erase(const iterator pos) noexcept(
+        !detail::checked && std::is_nothrow_destructible_v<value_type> &&
+        std::is_nothrow_move_assignable_v<value_type>)
+    {
+        check(pos);
+        CIRCBUF_ASSERT(pos != end());
+        return erase_at(static_cast<size_type>(pos - begin()), 1);
+    }
+
+    // Removes the elements in [first, last) and returns an iterator to the
+    // element following them. The elements on the shorter side of the range
+    // are shifted towards the gap, as std::deque does. Invalidates all
+    // iterators.
+    constexpr iterator
+    erase(const iterator first, const iterator last) noexcept(
+        !detail::checked && std::is_nothrow_destructible_v<value_type> &&
+        std::is_nothrow_move_assignable_v<value_type>)
+    {
+        check(first);
+        check(last);
+        CIRCBUF_ASSERT(first <= last);
+        return erase_at(static_cast<size_type>(first - begin()),
+                        static_cast<size_type>(last - first));
+    }
+
+    // Whether the elements occupy one contiguous range of the storage.
+    constexpr bool
+    is_linearized() const noexcept
+    {
+        return m_head + m_size <= MaxSize;
+    }
+
+    // Rotates the storage so that the elements are contiguous, starting at
+    // the first slot, unless they already are, and returns them in order.
+    // Invalidates all iterators if the storage is rotated.
+    constexpr std::span<value_type>
+    linearize() noexcept
+        requires(detail::is_trivial_storage_v<value_type>)
+    {
+        if (!is_linearized())
+        {
+            m_generation.bump();
+            std::rotate(m_data.begin(), m_data.begin() + m_head, m_data.end());
+            m_head = 0;
+        }
+        return {m_data.data() + m_head, m_size};
+    }
+
+    // Copies the elements in order to the front of destination which must
+    // hold at least size() elements. Returns the number of elements copied.
+    constexpr size_type
+    copy_linear(const std::span<value_type> destination) const noexcept(
+        !detail::checked && std::is_nothrow_copy_assignable_v<value_type>)
+    {
+        CIRCBUF_ASSERT(destination.size() >= m_size);
+        if constexpr (detail::is_trivial_storage_v<value_type>)
+        {
+            const size_type first =
+                std::min<size_type>(m_size, MaxSize - m_head);
+            const auto out = std::copy_n(
+                m_data.data() + m_head, first, destination.data());
+            std::copy_n(m_data.data(), m_size - first, out);
+        }
+        else
+        {
+            std::copy(begin(), end(), destination.begin());
+        }
+        return m_size;
+    }
+
+    // Writes a SnapshotHeader and the elements to writer, which is called
+    // with a std::span<const std::byte> at most three times.
+    template <typename Writer>
+        requires(std::is_invocable_v<Writer&, std::span<const std::byte>>)
+    void
+    serialize(Writer&& writer) const
+        requires(detail::is_trivial_storage_v<value_type>)
+    {
+        const SnapshotHeader header{SnapshotHeader::current_version,
+                                    sizeof(value_type),
+                                    MaxSize,
+                                    m_size};
+        writer(std::as_bytes(std::span{&header, 1}));
+        const size_type first = std::min<size_type>(m_size, MaxSize - m_head);
+        writer(std::as_bytes(std::span{m_data.data() + m_head, first}));
+        if (first < m_size)
+        {
+            writer(std::as_bytes(std::span{m_data.data(), m_size - first}));
+        }
+    }
+
+    // Replaces the elements with a snapshot written by serialize, reading
+    // straight into the storage. reader is called with a std::span<std::byte>
+    // to fill twice and returns whether it could. Returns false, leaving the
+    // buffer empty, if reading fails or the snapshot has a different version
+    // or element size or holds more than MaxSize elements. The capacity of
+    // the serialized buffer may differ. The policy sees the buffer cleared
+    // and then each restored element appended, so e.g. Statistics counts
+    // the restored elements as pushes.
+    template <typename Reader>
+        requires(std::is_invocable_r_v<bool, Reader&, std::span<std::byte>>)
+    bool
+    deserialize(Reader&& reader)
+        requires(detail::is_trivial_storage_v<value_type>)
+    {
+        clear();
+        SnapshotHeader header{};
+        if (!reader(std::as_writable_bytes(std::span{&header, 1})) ||
+            header.version != SnapshotHeader::current_version ||
+            header.element_size != sizeof(value_type) ||
+            header.size > MaxSize)
+        {
+            return false;
+        }
+        const auto size = static_cast<size_type>(header.size);
+        if (!reader(std::as_writable_bytes(std::span{m_data.data(), size})))
+        {
+            return false;
+        }
+        for (size_type i = 0; i < size; ++i)
+        {
+            ++m_size;
+            if constexpr (requires { m_policy.on_push(*this); })
+            {
+                m_policy.on_push(*this);
+            }
+        }
+        return true;
     }
 
     constexpr iterator
@@ -253,16 +725,190 @@ private:
     template <typename BufferType, bool Reverse>
     friend class CircularBufferIterator;
 
+    using index_type = detail::index_t<MaxSize>;
+
+    using Memory = std::conditional_t<detail::is_trivial_storage_v<value_type>,
+                                      value_type,
+                                      std::variant<std::monostate, value_type>>;
+
+    static constexpr value_type&
+    get(Memory& memory) noexcept
+    {
+        if constexpr (detail::is_trivial_storage_v<value_type>)
+        {
+            return memory;
+        }
+        else
+        {
+            return std::get<value_type>(memory);
+        }
+    }
+
+    static constexpr const value_type&
+    get(const Memory& memory) noexcept
+    {
+        if constexpr (detail::is_trivial_storage_v<value_type>)
+        {
+            return memory;
+        }
+        else
+        {
+            return std::get<value_type>(memory);
+        }
+    }
+
     constexpr value_type&
     at(const size_type index) noexcept
     {
-        return std::get<value_type>(m_data[index]);
+        return get(m_data[index]);
     }
 
     constexpr const value_type&
     at(const size_type index) const noexcept
     {
-        return std::get<value_type>(m_data[index]);
+        return get(m_data[index]);
+    }
+
+    template <typename... Type>
+    constexpr void
+    construct(const size_type index, Type&&... value) noexcept(
+        std::is_nothrow_constructible_v<value_type, Type...>)
+    {
+        if constexpr (detail::is_trivial_storage_v<value_type>)
+        {
+            std::construct_at(&m_data[index], std::forward<Type>(value)...);
+        }
+        else
+        {
+            m_data[index].template emplace<value_type>(
+                std::forward<Type>(value)...);
+        }
+    }
+
+    template <typename... Type>
+    constexpr void
+    push(Type&&... value) noexcept(
+        std::is_nothrow_constructible_v<value_type, Type...>)
+    {
+        if (full())
+        {
+            evict_front();
+        }
+        place(std::forward<Type>(value)...);
+    }
+
+    template <typename... Type>
+    constexpr void
+    place(Type&&... value) noexcept(
+        std::is_nothrow_constructible_v<value_type, Type...>)
+    {
+        increment();
+        construct(tail(), std::forward<Type>(value)...);
+        if constexpr (requires { m_policy.on_push(*this); })
+        {
+            m_policy.on_push(*this);
+        }
+    }
+
+    constexpr void
+    destroy(const size_type index) noexcept(
+        std::is_nothrow_destructible_v<value_type>)
+    {
+        if constexpr (!detail::is_trivial_storage_v<value_type>)
+        {
+            m_data[index].template emplace<std::monostate>();
+        }
+    }
+
+    constexpr iterator
+    erase_at(const size_type index, const size_type count) noexcept(
+        std::is_nothrow_destructible_v<value_type>&&
+            std::is_nothrow_move_assignable_v<value_type>)
+    {
+        if (count == 0)
+        {
+            return iterator{*this, index};
+        }
+        m_generation.bump();
+        if (index < m_size - index - count)
+        {
+            // move the leading elements up and drop the front
+            for (size_type i = index; i > 0; --i)
+            {
+                at(physical(i - 1 + count)) = std::move(at(physical(i - 1)));
+            }
+            for (size_type i = 0; i < count; ++i)
+            {
+                destroy(m_head);
+                m_head = next(m_head);
+                --m_size;
+                notify_pop();
+            }
+        }
+        else
+        {
+            // move the trailing elements down and drop the back
+            for (size_type i = index + count; i < m_size; ++i)
+            {
+                at(physical(i - count)) = std::move(at(physical(i)));
+            }
+            for (size_type i = 0; i < count; ++i)
+            {
+                destroy(tail());
+                --m_size;
+                notify_pop();
+            }
+        }
+        return iterator{*this, index};
+    }
+
+    // Hands the front element of a full buffer to the policy before it is
+    // overwritten.
+    constexpr void
+    evict_front() noexcept
+    {
+        notify_overwrite();
+        if constexpr (requires { m_policy.on_evict(std::move(front())); })
+        {
+            m_policy.on_evict(std::move(front()));
+        }
+        else if constexpr (requires(std::span<value_type> run) {
+                               m_policy.on_evict_range(run);
+                           })
+        {
+            m_policy.on_evict_range(std::span<value_type>{&front(), 1});
+        }
+    }
+
+    constexpr void
+    notify_pop() noexcept
+    {
+        if constexpr (requires { m_policy.on_pop(*this); })
+        {
+            m_policy.on_pop(*this);
+        }
+    }
+
+    constexpr void
+    notify_overwrite() noexcept
+    {
+        if constexpr (requires { m_policy.on_overwrite(*this); })
+        {
+            m_policy.on_overwrite(*this);
+        }
+    }
+
+    // Destroys the live elements only, leaving the other slots untouched.
+    constexpr void
+    destroy_all() noexcept(std::is_nothrow_destructible_v<value_type>)
+    {
+        for (size_type i = 0; i < m_size; ++i)
+        {
+            destroy(physical(i));
+        }
+        m_size = 0;
+        m_head = 0;
+        m_generation.bump();
     }
 
     constexpr void
@@ -271,7 +917,8 @@ private:
     {
         for (const auto& value : other)
         {
-            push_back(value);
+            increment();
+            construct(tail(), value);
         }
     }
 
@@ -281,44 +928,77 @@ private:
     {
         for (auto&& value : other)
         {
-            push_back(std::move(value));
+            increment();
+            construct(tail(), std::move(value));
         }
-        other.m_size = 0;
-        other.m_head = 0;
-        other.m_tail = 0;
+        other.destroy_all();
     }
 
+    // Makes room for one more element at the back. This invalidates all
+    // iterators: end() moves and reverse iterators, which count from the
+    // back, would refer to different elements.
     constexpr void
     increment() noexcept
     {
-        if (empty())
+        m_generation.bump();
+        if (full())
         {
-            ++m_size;
-        }
-        else if (full())
-        {
-            m_head = (m_head + 1) % MaxSize;
-            m_tail = (m_tail + 1) % MaxSize;
+            m_head = next(m_head);
         }
         else
         {
-            ++m_tail;
             ++m_size;
         }
     }
 
-    using Memory = std::variant<std::monostate, value_type>;
+    // Checks that pos is a valid iterator into this buffer.
+    constexpr void
+    check([[maybe_unused]] const iterator& pos) const
+        noexcept(!detail::checked)
+    {
+        CIRCBUF_ASSERT(pos.m_buffer == this);
+        CIRCBUF_ASSERT(pos.m_generation == m_generation);
+    }
+
+    static constexpr index_type
+    next(const index_type index) noexcept
+    {
+        return index + 1 == MaxSize ? 0 : static_cast<index_type>(index + 1);
+    }
+
+    // The storage slot of the element at index.
+    constexpr size_type
+    physical(const size_type index) const noexcept
+    {
+        const size_type position = m_head + index;
+        return position >= MaxSize ? position - MaxSize : position;
+    }
+
+    // The tail is derived rather than stored to keep the bookkeeping small.
+    constexpr size_type
+    tail() const noexcept
+    {
+        const size_type tail = m_head + m_size - 1;
+        return tail >= MaxSize ? tail - MaxSize : tail;
+    }
+
     std::array<Memory, MaxSize> m_data;
-    size_type m_size{};
-    size_type m_head{};
-    size_type m_tail{};
+    CIRCBUF_NO_UNIQUE_ADDRESS policy_type m_policy;
+    CIRCBUF_NO_UNIQUE_ADDRESS detail::Generation<detail::checked> m_generation;
+    index_type m_size{};
+    index_type m_head{};
 };
 
-template <typename T1, std::size_t MaxSize1, typename T2, std::size_t MaxSize2>
+template <typename T1,
+          std::size_t MaxSize1,
+          typename Policy1,
+          typename T2,
+          std::size_t MaxSize2,
+          typename Policy2>
     requires(std::equality_comparable_with<T1, T2>)
 constexpr bool
-operator==(const CircularBuffer<T1, MaxSize1>& lhs,
-           const CircularBuffer<T2, MaxSize2>& rhs) noexcept
+operator==(const CircularBuffer<T1, MaxSize1, Policy1>& lhs,
+           const CircularBuffer<T2, MaxSize2, Policy2>& rhs) noexcept
 {
     if (lhs.size() != rhs.size())
     {
@@ -327,48 +1007,73 @@ operator==(const CircularBuffer<T1, MaxSize1>& lhs,
     return std::equal(lhs.begin(), lhs.end(), rhs.begin());
 }
 
-template <typename T1, std::size_t MaxSize1, typename T2, std::size_t MaxSize2>
+template <typename T1,
+          std::size_t MaxSize1,
+          typename Policy1,
+          typename T2,
+          std::size_t MaxSize2,
+          typename Policy2>
     requires(std::equality_comparable_with<T1, T2>)
 constexpr bool
-operator!=(const CircularBuffer<T1, MaxSize1>& lhs,
-           const CircularBuffer<T2, MaxSize2>& rhs) noexcept
+operator!=(const CircularBuffer<T1, MaxSize1, Policy1>& lhs,
+           const CircularBuffer<T2, MaxSize2, Policy2>& rhs) noexcept
 {
     return !(lhs == rhs);
 }
 
-template <typename T1, std::size_t MaxSize1, typename T2, std::size_t MaxSize2>
+template <typename T1,
+          std::size_t MaxSize1,
+          typename Policy1,
+          typename T2,
+          std::size_t MaxSize2,
+          typename Policy2>
     requires(std::totally_ordered_with<T1, T2>)
 constexpr bool
-operator<(const CircularBuffer<T1, MaxSize1>& lhs,
-          const CircularBuffer<T2, MaxSize2>& rhs) noexcept
+operator<(const CircularBuffer<T1, MaxSize1, Policy1>& lhs,
+          const CircularBuffer<T2, MaxSize2, Policy2>& rhs) noexcept
 {
     return std::lexicographical_compare(
         lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
 }
 
-template <typename T1, std::size_t MaxSize1, typename T2, std::size_t MaxSize2>
+template <typename T1,
+          std::size_t MaxSize1,
+          typename Policy1,
+          typename T2,
+          std::size_t MaxSize2,
+          typename Policy2>
     requires(std::totally_ordered_with<T1, T2>)
 constexpr bool
-operator>(const CircularBuffer<T1, MaxSize1>& lhs,
-          const CircularBuffer<T2, MaxSize2>& rhs) noexcept
+operator>(const CircularBuffer<T1, MaxSize1, Policy1>& lhs,
+          const CircularBuffer<T2, MaxSize2, Policy2>& rhs) noexcept
 {
     return rhs < lhs;
 }
 
-template <typename T1, std::size_t MaxSize1, typename T2, std::size_t MaxSize2>
+template <typename T1,
+          std::size_t MaxSize1,
+          typename Policy1,
+          typename T2,
+          std::size_t MaxSize2,
+          typename Policy2>
     requires(std::totally_ordered_with<T1, T2>)
 constexpr bool
-operator<=(const CircularBuffer<T1, MaxSize1>& lhs,
-           const CircularBuffer<T2, MaxSize2>& rhs) noexcept
+operator<=(const CircularBuffer<T1, MaxSize1, Policy1>& lhs,
+           const CircularBuffer<T2, MaxSize2, Policy2>& rhs) noexcept
 {
     return !(lhs > rhs);
 }
 
-template <typename T1, std::size_t MaxSize1, typename T2, std::size_t MaxSize2>
+template <typename T1,
+          std::size_t MaxSize1,
+          typename Policy1,
+          typename T2,
+          std::size_t MaxSize2,
+          typename Policy2>
     requires(std::totally_ordered_with<T1, T2>)
 constexpr bool
-operator>=(const CircularBuffer<T1, MaxSize1>& lhs,
-           const CircularBuffer<T2, MaxSize2>& rhs) noexcept
+operator>=(const CircularBuffer<T1, MaxSize1, Policy1>& lhs,
+           const CircularBuffer<T2, MaxSize2, Policy2>& rhs) noexcept
 {
     return !(lhs < rhs);
 }
@@ -396,52 +1101,34 @@ public:
     explicit constexpr CircularBufferIterator(BufferType& buffer,
                                               const size_type index)
         : m_buffer{&buffer}
+        , m_slot{locate(buffer, static_cast<difference_type>(index))}
         , m_index{static_cast<difference_type>(index)}
+        , m_generation{buffer.m_generation}
     {
     }
 
     constexpr contained_ref
-    operator*() noexcept
+    operator*() noexcept(!detail::checked)
     {
-        if constexpr (Reverse)
-        {
-            return m_buffer->at((m_buffer->m_head + m_buffer->m_size -
-                                 static_cast<size_type>(m_index) - 1) %
-                                BufferType::max_size());
-        }
-        else
-        {
-            return m_buffer->at(
-                (m_buffer->m_head + static_cast<size_type>(m_index)) %
-                BufferType::max_size());
-        }
+        check_dereferenceable();
+        return BufferType::get(*m_slot);
     }
 
     constexpr contained_ref
-    operator*() const noexcept
+    operator*() const noexcept(!detail::checked)
     {
-        if constexpr (Reverse)
-        {
-            return m_buffer->at((m_buffer->m_head + m_buffer->m_size -
-                                 static_cast<size_type>(m_index) - 1) %
-                                BufferType::max_size());
-        }
-        else
-        {
-            return m_buffer->at(
-                (m_buffer->m_head + static_cast<size_type>(m_index)) %
-                BufferType::max_size());
-        }
+        check_dereferenceable();
+        return BufferType::get(*m_slot);
     }
 
     constexpr contained_ptr
-    operator->() noexcept
+    operator->() noexcept(!detail::checked)
     {
         return &this->operator*();
     }
 
     constexpr contained_ptr
-    operator->() const noexcept
+    operator->() const noexcept(!detail::checked)
     {
         return &this->operator*();
     }
@@ -450,6 +1137,14 @@ public:
     operator++() noexcept
     {
         ++m_index;
+        if constexpr (Reverse)
+        {
+            retreat();
+        }
+        else
+        {
+            advance();
+        }
         return *this;
     }
 
@@ -468,12 +1163,14 @@ public:
         return temp += offset;
     }
 
+    // Moves by offset logical positions. The result must lie within
+    // [begin(), end()] of the buffer.
     constexpr self_type&
-    operator+=(const difference_type offset)
+    operator+=(const difference_type offset) noexcept(!detail::checked)
     {
-        const difference_type next = (m_index + offset) %
-            static_cast<difference_type>(BufferType::max_size());
-        m_index = next;
+        CIRCBUF_ASSERT(m_generation == m_buffer->m_generation);
+        m_index += offset;
+        m_slot = locate(*m_buffer, m_index);
         return *this;
     }
 
@@ -481,6 +1178,14 @@ public:
     operator--() noexcept
     {
         --m_index;
+        if constexpr (Reverse)
+        {
+            advance();
+        }
+        else
+        {
+            retreat();
+        }
         return *this;
     }
 
@@ -500,24 +1205,92 @@ public:
     }
 
     constexpr self_type&
-    operator-=(const difference_type offset) noexcept
+    operator-=(const difference_type offset) noexcept(!detail::checked)
     {
         return *this += -offset;
     }
 
     constexpr contained_ref
-    operator[](const difference_type offset) noexcept
+    operator[](const difference_type offset) noexcept(!detail::checked)
     {
         return *(*this + offset);
     }
 
     constexpr contained_ref
-    operator[](const difference_type offset) const noexcept
+    operator[](const difference_type offset) const noexcept(!detail::checked)
     {
         return *(*this + offset);
     }
 
 private:
+    using memory_type =
+        std::conditional_t<std::is_const_v<BufferType>,
+                           const typename BufferType::Memory,
+                           typename BufferType::Memory>;
+
+    // Maps a logical position in [0, size()] onto its storage slot. Since
+    // the head lies within the storage, the position wraps at most once in
+    // either direction, so a comparison replaces the modulo.
+    static constexpr memory_type*
+    locate(BufferType& buffer,
+           const difference_type index) noexcept(!detail::checked)
+    {
+        CIRCBUF_ASSERT(index >= 0 &&
+                       index <= static_cast<difference_type>(buffer.size()));
+        constexpr auto max_size =
+            static_cast<difference_type>(BufferType::max_size());
+        const auto head = static_cast<difference_type>(buffer.m_head);
+        difference_type position{};
+        if constexpr (Reverse)
+        {
+            position =
+                head + static_cast<difference_type>(buffer.m_size) - 1 - index;
+        }
+        else
+        {
+            position = head + index;
+        }
+        if (position >= max_size)
+        {
+            position -= max_size;
+        }
+        else if (position < 0)
+        {
+            position += max_size;
+        }
+        return buffer.m_data.data() + position;
+    }
+
+    // Checks that the iterator still refers to an element of its buffer.
+    constexpr void
+    check_dereferenceable() const noexcept(!detail::checked)
+    {
+        CIRCBUF_ASSERT(m_buffer != nullptr);
+        CIRCBUF_ASSERT(m_generation == m_buffer->m_generation);
+        CIRCBUF_ASSERT(m_index >= 0);
+        CIRCBUF_ASSERT(m_index <
+                       static_cast<difference_type>(m_buffer->size()));
+    }
+
+    constexpr void
+    advance() noexcept
+    {
+        if (++m_slot == m_buffer->m_data.data() + BufferType::max_size())
+        {
+            m_slot = m_buffer->m_data.data();
+        }
+    }
+
+    constexpr void
+    retreat() noexcept
+    {
+        if (m_slot == m_buffer->m_data.data())
+        {
+            m_slot += BufferType::max_size();
+        }
+        --m_slot;
+    }
+
     template <typename BufferType1,
               bool Reverse1,
               typename BufferType2,
@@ -566,10 +1339,17 @@ private:
     friend constexpr auto
     operator-(const typename CircularBufferIterator<BufferType1,
                                                     Reverse1>::difference_type,
-              const CircularBufferIterator<BufferType1, Reverse1>&) noexcept;
+              const CircularBufferIterator<BufferType1, Reverse1>&) noexcept(
+        !detail::checked);
+
+    template <typename T1, std::size_t MaxSize1, typename Policy1>
+        requires(MaxSize1 > 0)
+    friend class CircularBuffer;
 
     BufferType* m_buffer{};
+    memory_type* m_slot{};
     difference_type m_index{};
+    CIRCBUF_NO_UNIQUE_ADDRESS detail::Generation<detail::checked> m_generation;
 };
 
 template <typename BufferType1,
@@ -633,7 +1413,8 @@ constexpr auto
 operator+(
     const typename CircularBufferIterator<BufferType, Reverse>::difference_type
         offset,
-    const CircularBufferIterator<BufferType, Reverse>& it) noexcept
+    const CircularBufferIterator<BufferType, Reverse>& it) noexcept(
+    !detail::checked)
 {
     return it + offset;
 }
@@ -643,14 +1424,14 @@ constexpr auto
 operator-(
     const typename CircularBufferIterator<BufferType, Reverse>::difference_type
         offset,
-    const CircularBufferIterator<BufferType, Reverse>& it) noexcept
+    const CircularBufferIterator<BufferType, Reverse>& it) noexcept(
+    !detail::checked)
 {
     auto temp = it;
-    temp.m_index = (offset - it.m_index) %
-        static_cast<typename CircularBufferIterator<BufferType,
-                                                    Reverse>::difference_type>(
-                       BufferType::max_size());
+    temp.m_index = offset - it.m_index;
+    temp.m_slot = temp.locate(*temp.m_buffer, temp.m_index);
     return temp;
 }
 
+} // namespace CIRCBUF_ABI_NAMESPACE
 } // namespace circbuf
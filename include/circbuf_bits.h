@@ -0,0 +1,290 @@
+#pragma once
+
+#include "circbuf.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace circbuf
+{
+inline namespace CIRCBUF_ABI_NAMESPACE
+{
+
+// A circular buffer of Bits-wide unsigned values (bool for one bit) packed
+// into 64-bit words. Besides the usual FIFO operations it counts values
+// over the whole window or its most recent part a word at a time, and
+// appends up to a word of values at once:
+//
+//   BitCircularBuffer<4096> acks;
+//   acks.push_back(true);
+//   acks.push_back_word(0b1011, 4);
+//   auto recent = acks.count_last(1000); // set flags among the last 1000
+//
+// Bits must divide 64 so that no value straddles two words.
+template <std::size_t MaxSize, std::size_t Bits = 1>
+    requires(MaxSize > 0 && Bits > 0 && Bits <= 32 && 64 % Bits == 0)
+class BitCircularBuffer
+{
+public:
+    using value_type = std::conditional_t<Bits == 1, bool, std::uint32_t>;
+    using size_type = std::size_t;
+    using word_type = std::uint64_t;
+
+    // Number of values per word.
+    static constexpr size_type values_per_word = 64 / Bits;
+
+    consteval static size_type
+    max_size() noexcept
+    {
+        return MaxSize;
+    }
+
+    constexpr size_type
+    size() const noexcept
+    {
+        return m_size;
+    }
+
+    constexpr bool
+    empty() const noexcept
+    {
+        return m_size == 0;
+    }
+
+    constexpr bool
+    full() const noexcept
+    {
+        return m_size == MaxSize;
+    }
+
+    constexpr void
+    clear() noexcept
+    {
+        m_size = 0;
+        m_head = 0;
+    }
+
+    constexpr value_type
+    operator[](const size_type index) const noexcept(!detail::checked)
+    {
+        CIRCBUF_ASSERT(index < m_size);
+        return read(physical(index));
+    }
+
+    constexpr value_type
+    front() const noexcept(!detail::checked)
+    {
+        CIRCBUF_ASSERT(!empty());
+        return read(m_head);
+    }
+
+    constexpr value_type
+    back() const noexcept(!detail::checked)
+    {
+        CIRCBUF_ASSERT(!empty());
+        return read(physical(m_size - 1));
+    }
+
+    constexpr void
+    set(const size_type index,
+        const value_type value) noexcept(!detail::checked)
+    {
+        CIRCBUF_ASSERT(index < m_size);
+        write(physical(index), 1, static_cast<word_type>(value));
+    }
+
+    constexpr void
+    push_back(const value_type value) noexcept
+    {
+        increment(1);
+        write(physical(m_size - 1), 1, static_cast<word_type>(value));
+    }
+
+    // Appends the count values held in the low count * Bits bits of word,
+    // least significant first. count must not exceed values_per_word.
+    constexpr void
+    push_back_word(word_type word, size_type count) noexcept
+    {
+        if (count > MaxSize)
+        {
+            // the leading values would be overwritten right away
+            word >>= (count - MaxSize) * Bits;
+            count = MaxSize;
+        }
+        if (count == 0)
+        {
+            return;
+        }
+        increment(count);
+        const auto start = physical(m_size - count);
+        const auto first = std::min(count, MaxSize - start);
+        write(start, first, word);
+        if (first < count)
+        {
+            write(0, count - first, word >> (first * Bits));
+        }
+    }
+
+    constexpr value_type
+    pop_front() noexcept(!detail::checked)
+    {
+        CIRCBUF_ASSERT(!empty());
+        const auto value = read(m_head);
+        m_head = static_cast<index_type>(physical(1));
+        --m_size;
+        return value;
+    }
+
+    // Number of held values equal to value.
+    constexpr size_type
+    count(const value_type value) const noexcept
+    {
+        return count_last(m_size, value);
+    }
+
+    // Number of set flags.
+    constexpr size_type
+    count() const noexcept
+        requires(Bits == 1)
+    {
+        return count(true);
+    }
+
+    // Number of values equal to value among the last count ones, or among
+    // all of them if there are fewer.
+    constexpr size_type
+    count_last(size_type count, const value_type value) const noexcept
+    {
+        count = std::min(count, size_type{m_size});
+        const auto start = physical(m_size - count);
+        const auto first = std::min(count, MaxSize - start);
+        return count_range(start, first, static_cast<word_type>(value)) +
+            count_range(0, count - first, static_cast<word_type>(value));
+    }
+
+    // Number of set flags among the last count ones, or among all of them
+    // if there are fewer.
+    constexpr size_type
+    count_last(const size_type count) const noexcept
+        requires(Bits == 1)
+    {
+        return count_last(count, true);
+    }
+
+private:
+    using index_type = detail::index_t<MaxSize>;
+
+    static constexpr size_type word_count = (MaxSize * Bits + 63) / 64;
+
+    static constexpr word_type
+    low_mask(const size_type bits) noexcept
+    {
+        return bits >= 64 ? ~word_type{} : (word_type{1} << bits) - 1;
+    }
+
+    // A word with the lowest bit of every value set.
+    static constexpr word_type
+    value_lows() noexcept
+    {
+        word_type word{};
+        for (size_type i = 0; i < values_per_word; ++i)
+        {
+            word |= word_type{1} << (i * Bits);
+        }
+        return word;
+    }
+
+    constexpr size_type
+    physical(const size_type index) const noexcept
+    {
+        const size_type position = m_head + index;
+        return position >= MaxSize ? position - MaxSize : position;
+    }
+
+    constexpr void
+    increment(const size_type count) noexcept
+    {
+        const size_type size = m_size + count;
+        if (size > MaxSize)
+        {
+            m_head = static_cast<index_type>(physical(size - MaxSize));
+            m_size = static_cast<index_type>(MaxSize);
+        }
+        else
+        {
+            m_size = static_cast<index_type>(size);
+        }
+    }
+
+    constexpr value_type
+    read(const size_type position) const noexcept
+    {
+        const auto bit = position * Bits;
+        return static_cast<value_type>((m_words[bit / 64] >> (bit % 64)) &
+                                       low_mask(Bits));
+    }
+
+    // Writes count values starting at position which must all lie in the
+    // storage. Since values never straddle words at most two words change.
+    constexpr void
+    write(const size_type position,
+          const size_type count,
+          const word_type values) noexcept
+    {
+        auto bit = position * Bits;
+        auto bits = count * Bits;
+        auto source = values & low_mask(bits);
+        while (bits > 0)
+        {
+            const auto offset = bit % 64;
+            const auto chunk = std::min<size_type>(bits, 64 - offset);
+            auto& word = m_words[bit / 64];
+            word = (word & ~(low_mask(chunk) << offset)) |
+                ((source & low_mask(chunk)) << offset);
+            source = chunk >= 64 ? 0 : source >> chunk;
+            bit += chunk;
+            bits -= chunk;
+        }
+    }
+
+    // Counts values equal to value among count values from position.
+    constexpr size_type
+    count_range(const size_type position,
+                const size_type count,
+                const word_type value) const noexcept
+    {
+        constexpr auto lows = value_lows();
+        const auto pattern = lows * (value & low_mask(Bits));
+        auto bit = position * Bits;
+        const auto end = bit + count * Bits;
+        size_type matches{};
+        while (bit < end)
+        {
+            const auto offset = bit % 64;
+            const auto chunk = std::min<size_type>(end - bit, 64 - offset);
+            // fields differing from value have a non-zero lowest bit after
+            // folding all their bits onto it
+            auto diff = (m_words[bit / 64] >> offset) ^ pattern;
+            for (size_type shift = 1; shift < Bits; shift *= 2)
+            {
+                diff |= diff >> shift;
+            }
+            const auto mismatches = static_cast<size_type>(
+                std::popcount(diff & lows & low_mask(chunk)));
+            matches += chunk / Bits - mismatches;
+            bit += chunk;
+        }
+        return matches;
+    }
+
+    std::array<word_type, word_count> m_words{};
+    index_type m_size{};
+    index_type m_head{};
+};
+
+} // namespace CIRCBUF_ABI_NAMESPACE
+} // namespace circbuf
@@ -0,0 +1,254 @@
+#pragma once
+
+#include "circbuf.h"
+#include "circbuf_table.h"
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <utility>
+
+namespace circbuf
+{
+inline namespace CIRCBUF_ABI_NAMESPACE
+{
+
+// A fixed-capacity cache evicting with the CLOCK (second chance)
+// algorithm, which approximates LRU:
+//
+//   ClockCache<InstrumentId, Metadata, 4096> cache;
+//   if (const auto* metadata = cache.find(id))
+//   {
+//       return *metadata;
+//   }
+//   return cache.put(id, load(id));
+//
+// Entries are kept in a ring, each with a reference bit that find sets.
+// When a new key arrives at a full cache, the hand sweeps the ring from
+// where it stopped last, clearing set reference bits, and evicts the first
+// entry whose bit is already clear. Keys are located through an open
+// addressing table with linear probing, so after construction nothing is
+// allocated.
+template <typename Key,
+          typename Value,
+          std::size_t Capacity,
+          typename Hash = std::hash<Key>,
+          typename KeyEqual = std::equal_to<Key>>
+    requires(Capacity > 0)
+class ClockCache
+{
+public:
+    using key_type = Key;
+    using mapped_type = Value;
+    using size_type = std::size_t;
+
+    constexpr ClockCache() noexcept
+    {
+        reset();
+    }
+
+    constexpr explicit ClockCache(Hash hash, KeyEqual equal = KeyEqual{})
+        : m_table{std::move(hash), std::move(equal)}
+    {
+        reset();
+    }
+
+    consteval static size_type
+    capacity() noexcept
+    {
+        return Capacity;
+    }
+
+    constexpr size_type
+    size() const noexcept
+    {
+        return Capacity - m_free_count;
+    }
+
+    constexpr bool
+    empty() const noexcept
+    {
+        return m_free_count == Capacity;
+    }
+
+    constexpr bool
+    full() const noexcept
+    {
+        return m_free_count == 0;
+    }
+
+    // Whether key is cached. Unlike find, this does not count as a use.
+    constexpr bool
+    contains(const key_type& key) const
+    {
+        return m_table[probe(key)] != none;
+    }
+
+    // The value of key or nullptr if key is not cached. Marks key as
+    // recently used.
+    constexpr mapped_type*
+    find(const key_type& key)
+    {
+        const auto index = m_table[probe(key)];
+        if (index == none)
+        {
+            return nullptr;
+        }
+        auto& entry = m_entries[index];
+        entry.referenced = true;
+        return &entry.item->second;
+    }
+
+    // Caches value under key, replacing a previous value of key or, if the
+    // cache is full, evicting the entry chosen by the hand.
+    constexpr mapped_type&
+    put(const key_type& key, mapped_type value)
+    {
+        auto position = probe(key);
+        if (m_table[position] != none)
+        {
+            auto& entry = m_entries[m_table[position]];
+            entry.item->second = std::move(value);
+            entry.referenced = true;
+            return entry.item->second;
+        }
+        if (full())
+        {
+            evict();
+            position = probe(key);
+        }
+        // the slot is only taken off the free list once the entry is
+        // constructed, so a throwing copy or move leaves it free
+        const auto index = m_free[m_free_count - 1];
+        auto& entry = m_entries[index];
+        entry.item.emplace(key, std::move(value));
+        --m_free_count;
+        entry.referenced = false;
+        m_table[position] = index;
+        return entry.item->second;
+    }
+
+    // Removes key. Returns false if key was not cached.
+    constexpr bool
+    erase(const key_type& key)
+    {
+        const auto position = probe(key);
+        if (m_table[position] == none)
+        {
+            return false;
+        }
+        remove(position);
+        return true;
+    }
+
+    constexpr void
+    clear() noexcept
+    {
+        for (auto& entry : m_entries)
+        {
+            entry.item.reset();
+            entry.referenced = false;
+        }
+        reset();
+    }
+
+    // Calls fn(key, value) for every cached entry in ring order.
+    template <typename Function>
+    constexpr void
+    for_each(Function&& fn) const
+    {
+        for (const auto& entry : m_entries)
+        {
+            if (entry.item)
+            {
+                fn(entry.item->first, entry.item->second);
+            }
+        }
+    }
+
+private:
+    using index_type = detail::index_t<Capacity>;
+
+    // At most half of the table is used, which keeps probe sequences short.
+    using table_type = detail::OpenAddressingTable<
+        Key,
+        std::array<index_type, std::bit_ceil(Capacity * 2)>,
+        Hash,
+        KeyEqual>;
+
+    static constexpr index_type none = table_type::none;
+
+    struct Entry
+    {
+        std::optional<std::pair<Key, Value>> item;
+        bool referenced{};
+    };
+
+    constexpr void
+    reset() noexcept
+    {
+        m_table.clear();
+        for (size_type index = 0; index < Capacity; ++index)
+        {
+            m_free[index] = static_cast<index_type>(Capacity - 1 - index);
+        }
+        m_free_count = Capacity;
+        m_hand = 0;
+    }
+
+    // Looks up the key of an entry for the table.
+    constexpr auto
+    key_of() const noexcept
+    {
+        return [this](const index_type index) -> const key_type& {
+            return m_entries[index].item->first;
+        };
+    }
+
+    // The table position holding key or, if key is not cached, the empty
+    // position where it would be inserted.
+    constexpr size_type
+    probe(const key_type& key) const
+    {
+        return m_table.probe(key, key_of());
+    }
+
+    // Frees the entry at a table position.
+    constexpr void
+    remove(const size_type position)
+    {
+        const auto index = m_table[position];
+        m_table.remove(position, key_of());
+        m_entries[index].item.reset();
+        m_free[m_free_count++] = index;
+    }
+
+    constexpr void
+    evict()
+    {
+        for (;;)
+        {
+            auto& entry = m_entries[m_hand];
+            m_hand = m_hand + 1 == Capacity
+                ? 0
+                : static_cast<index_type>(m_hand + 1);
+            if (!entry.referenced)
+            {
+                remove(probe(entry.item->first));
+                return;
+            }
+            entry.referenced = false;
+        }
+    }
+
+    std::array<Entry, Capacity> m_entries;
+    table_type m_table;
+    std::array<index_type, Capacity> m_free;
+    size_type m_free_count{Capacity};
+    index_type m_hand{};
+};
+
+} // namespace CIRCBUF_ABI_NAMESPACE
+} // namespace circbuf
@@ -0,0 +1,343 @@
+#pragma once
+
+#include "circbuf.h"
+
+#include <coroutine>
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace circbuf
+{
+inline namespace CIRCBUF_ABI_NAMESPACE
+{
+
+namespace detail
+{
+
+// Stands in for a mutex where no synchronization is needed.
+struct NullMutex
+{
+    constexpr void
+    lock() noexcept
+    {
+    }
+
+    constexpr void
+    unlock() noexcept
+    {
+    }
+};
+
+} // namespace detail
+
+// Resumes coroutines right away on the calling thread.
+struct InlineScheduler
+{
+    void
+    operator()(const std::coroutine_handle<> handle) const
+    {
+        handle.resume();
+    }
+};
+
+// A bounded channel for coroutines. co_await push(value) suspends while the
+// channel is full and co_await pop() suspends while it is empty:
+//
+//   Channel<Message, 64> channel;
+//
+//   // producer coroutine
+//   if (!co_await channel.push(message)) { /* channel was closed */ }
+//
+//   // consumer coroutine
+//   while (auto message = co_await channel.pop()) { handle(*message); }
+//
+// Elements are held in a CircularBuffer. Suspended coroutines wait in
+// intrusive FIFO lists threaded through their awaiters, which live in the
+// coroutine frames, so suspending never allocates. Waiters are resumed
+// through Scheduler, e.g. to post them to an executor instead of resuming
+// them inline. Mutex guards the channel state: detail::NullMutex for
+// single-threaded use (Channel), std::mutex for producers and consumers on
+// different threads (ConcurrentChannel).
+template <typename T,
+          std::size_t MaxSize,
+          typename Mutex = detail::NullMutex,
+          typename Scheduler = InlineScheduler>
+class BasicChannel
+{
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+
+    class PushAwaiter;
+    class PopAwaiter;
+
+    BasicChannel() = default;
+
+    explicit BasicChannel(Scheduler scheduler)
+        : m_scheduler{std::forward<Scheduler>(scheduler)}
+    {
+    }
+
+    BasicChannel(const BasicChannel&) = delete;
+    BasicChannel&
+    operator=(const BasicChannel&) = delete;
+
+    consteval static size_type
+    max_size() noexcept
+    {
+        return MaxSize;
+    }
+
+    size_type
+    size() const
+    {
+        std::lock_guard lock{m_mutex};
+        return m_buffer.size();
+    }
+
+    bool
+    closed() const
+    {
+        std::lock_guard lock{m_mutex};
+        return m_closed;
+    }
+
+    // Awaiting the result pushes value, suspending while the channel is
+    // full. It yields false if the channel was closed before value could be
+    // pushed.
+    [[nodiscard]] PushAwaiter
+    push(value_type value)
+    {
+        return PushAwaiter{*this, std::move(value)};
+    }
+
+    // Awaiting the result pops the front element, suspending while the
+    // channel is empty. It yields std::nullopt once the channel is closed
+    // and drained.
+    [[nodiscard]] PopAwaiter
+    pop()
+    {
+        return PopAwaiter{*this};
+    }
+
+    // Closes the channel. Suspended pushes complete with false, suspended
+    // pops with std::nullopt. Elements already in the channel can still be
+    // popped.
+    void
+    close()
+    {
+        PushAwaiter* pushers{};
+        PopAwaiter* poppers{};
+        {
+            std::lock_guard lock{m_mutex};
+            m_closed = true;
+            pushers = std::exchange(m_pushers.first, nullptr);
+            poppers = std::exchange(m_poppers.first, nullptr);
+            m_pushers.last = nullptr;
+            m_poppers.last = nullptr;
+        }
+        // a resumed coroutine may destroy its awaiter, so read next first
+        while (pushers)
+        {
+            const auto next = std::exchange(pushers->m_next, nullptr);
+            pushers->m_pushed = false;
+            m_scheduler(pushers->m_handle);
+            pushers = next;
+        }
+        while (poppers)
+        {
+            const auto next = std::exchange(poppers->m_next, nullptr);
+            m_scheduler(poppers->m_handle);
+            poppers = next;
+        }
+    }
+
+    class PushAwaiter
+    {
+    public:
+        PushAwaiter(const PushAwaiter&) = delete;
+        PushAwaiter&
+        operator=(const PushAwaiter&) = delete;
+
+        bool
+        await_ready() const noexcept
+        {
+            return false;
+        }
+
+        bool
+        await_suspend(const std::coroutine_handle<> handle)
+        {
+            std::coroutine_handle<> resume;
+            {
+                std::lock_guard lock{m_channel.m_mutex};
+                if (m_channel.m_closed)
+                {
+                    m_pushed = false;
+                    return false;
+                }
+                if (const auto popper = m_channel.m_poppers.pop())
+                {
+                    popper->m_value.emplace(std::move(m_value));
+                    resume = popper->m_handle;
+                }
+                else if (!m_channel.m_buffer.full())
+                {
+                    m_channel.m_buffer.push_back(std::move(m_value));
+                    return false;
+                }
+                else
+                {
+                    m_handle = handle;
+                    m_channel.m_pushers.push(this);
+                    return true;
+                }
+            }
+            m_channel.m_scheduler(resume);
+            return false;
+        }
+
+        bool
+        await_resume() const noexcept
+        {
+            return m_pushed;
+        }
+
+    private:
+        friend class BasicChannel;
+
+        PushAwaiter(BasicChannel& channel, value_type&& value)
+            : m_channel{channel}
+            , m_value{std::move(value)}
+        {
+        }
+
+        BasicChannel& m_channel;
+        value_type m_value;
+        std::coroutine_handle<> m_handle;
+        PushAwaiter* m_next{};
+        bool m_pushed{true};
+    };
+
+    class PopAwaiter
+    {
+    public:
+        PopAwaiter(const PopAwaiter&) = delete;
+        PopAwaiter&
+        operator=(const PopAwaiter&) = delete;
+
+        bool
+        await_ready() const noexcept
+        {
+            return false;
+        }
+
+        bool
+        await_suspend(const std::coroutine_handle<> handle)
+        {
+            std::coroutine_handle<> resume;
+            {
+                std::lock_guard lock{m_channel.m_mutex};
+                if (m_channel.m_buffer.empty())
+                {
+                    if (m_channel.m_closed)
+                    {
+                        return false;
+                    }
+                    m_handle = handle;
+                    m_channel.m_poppers.push(this);
+                    return true;
+                }
+                m_value.emplace(m_channel.m_buffer.pop_front());
+                // the buffer has room now for the first waiting pusher
+                if (const auto pusher = m_channel.m_pushers.pop())
+                {
+                    m_channel.m_buffer.push_back(std::move(pusher->m_value));
+                    resume = pusher->m_handle;
+                }
+            }
+            if (resume)
+            {
+                m_channel.m_scheduler(resume);
+            }
+            return false;
+        }
+
+        std::optional<value_type>
+        await_resume() noexcept(
+            std::is_nothrow_move_constructible_v<value_type>)
+        {
+            return std::move(m_value);
+        }
+
+    private:
+        friend class BasicChannel;
+
+        explicit PopAwaiter(BasicChannel& channel)
+            : m_channel{channel}
+        {
+        }
+
+        BasicChannel& m_channel;
+        std::optional<value_type> m_value;
+        std::coroutine_handle<> m_handle;
+        PopAwaiter* m_next{};
+    };
+
+private:
+    // An intrusive FIFO list of awaiters.
+    template <typename Awaiter>
+    struct WaitList
+    {
+        void
+        push(Awaiter* awaiter) noexcept
+        {
+            if (last)
+            {
+                last->m_next = awaiter;
+            }
+            else
+            {
+                first = awaiter;
+            }
+            last = awaiter;
+        }
+
+        Awaiter*
+        pop() noexcept
+        {
+            const auto awaiter = first;
+            if (awaiter)
+            {
+                first = std::exchange(awaiter->m_next, nullptr);
+                if (!first)
+                {
+                    last = nullptr;
+                }
+            }
+            return awaiter;
+        }
+
+        Awaiter* first{};
+        Awaiter* last{};
+    };
+
+    CircularBuffer<value_type, MaxSize> m_buffer;
+    WaitList<PushAwaiter> m_pushers;
+    WaitList<PopAwaiter> m_poppers;
+    mutable Mutex m_mutex;
+    Scheduler m_scheduler;
+    bool m_closed{};
+};
+
+template <typename T, std::size_t MaxSize, typename Scheduler = InlineScheduler>
+using Channel = BasicChannel<T, MaxSize, detail::NullMutex, Scheduler>;
+
+template <typename T, std::size_t MaxSize, typename Scheduler = InlineScheduler>
+using ConcurrentChannel = BasicChannel<T, MaxSize, std::mutex, Scheduler>;
+
+} // namespace CIRCBUF_ABI_NAMESPACE
+} // namespace circbuf
@@ -0,0 +1,601 @@
+#pragma once
+
+#include "circbuf.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+
+namespace circbuf
+{
+inline namespace CIRCBUF_ABI_NAMESPACE
+{
+
+namespace detail
+{
+
+// Encodes floating-point values as the XOR with their predecessor, storing
+// only the bits between the leading and trailing zeros of the XOR (Gorilla
+// encoding):
+//
+//   '0'                                     same value
+//   '10' meaningful bits                    within the previous window
+//   '11' 5 bits leading, 6 bits length, meaningful bits
+template <typename T>
+class XorCodec
+{
+public:
+    using bits_type =
+        std::conditional_t<sizeof(T) == 4, std::uint32_t, std::uint64_t>;
+
+    static constexpr std::size_t max_bits = 2 + 5 + 6 + 64;
+
+    template <typename Writer>
+    constexpr void
+    encode(Writer& writer, const T value) noexcept
+    {
+        const auto bits = widen(value);
+        const auto diff = bits ^ m_previous;
+        m_previous = bits;
+        if (diff == 0)
+        {
+            writer.write(0, 1);
+            return;
+        }
+        const auto leading = std::min(std::countl_zero(diff), 31);
+        const auto trailing = std::countr_zero(diff);
+        if (m_length > 0 && leading >= m_leading &&
+            trailing >= 64 - m_leading - m_length)
+        {
+            writer.write(0b01, 2);
+            writer.write(diff >> (64 - m_leading - m_length), m_length);
+            return;
+        }
+        m_leading = leading;
+        m_length = 64 - leading - trailing;
+        writer.write(0b11, 2);
+        writer.write(static_cast<std::uint64_t>(m_leading), 5);
+        // a length of 64 is stored as 0
+        writer.write(static_cast<std::uint64_t>(m_length & 63), 6);
+        writer.write(diff >> trailing, m_length);
+    }
+
+    template <typename Reader>
+    constexpr T
+    decode(Reader& reader) noexcept
+    {
+        if (reader.read(1) != 0)
+        {
+            if (reader.read(1) != 0)
+            {
+                m_leading = static_cast<int>(reader.read(5));
+                m_length = static_cast<int>(reader.read(6));
+                if (m_length == 0)
+                {
+                    m_length = 64;
+                }
+            }
+            const auto trailing = 64 - m_leading - m_length;
+            m_previous ^= reader.read(m_length) << trailing;
+        }
+        return std::bit_cast<T>(static_cast<bits_type>(m_previous >> shift));
+    }
+
+    // Starts a block whose first value is stored raw.
+    constexpr void
+    reset(const T value) noexcept
+    {
+        m_previous = widen(value);
+        m_leading = 0;
+        m_length = 0;
+    }
+
+    static constexpr std::uint64_t
+    raw(const T value) noexcept
+    {
+        return std::bit_cast<bits_type>(value);
+    }
+
+    static constexpr T
+    from_raw(const std::uint64_t bits) noexcept
+    {
+        return std::bit_cast<T>(static_cast<bits_type>(bits));
+    }
+
+private:
+    // Values narrower than 64 bits are kept in the upper bits so that sign
+    // and exponent count towards the leading zeros.
+    static constexpr int shift = 64 - static_cast<int>(sizeof(T)) * 8;
+
+    static constexpr std::uint64_t
+    widen(const T value) noexcept
+    {
+        return static_cast<std::uint64_t>(std::bit_cast<bits_type>(value))
+            << shift;
+    }
+
+    std::uint64_t m_previous{};
+    int m_leading{};
+    int m_length{};
+};
+
+// Encodes integral values as the zigzag-encoded difference between
+// successive deltas (delta-of-delta encoding), using the shortest of these
+// forms that fits:
+//
+//   '0'                    same delta as before
+//   '10'    7 bits
+//   '110'   12 bits
+//   '1110'  20 bits
+//   '11110' 32 bits
+//   '11111' 64 bits
+template <typename T>
+class DeltaCodec
+{
+public:
+    static constexpr std::size_t max_bits = 5 + 64;
+
+    template <typename Writer>
+    constexpr void
+    encode(Writer& writer, const T value) noexcept
+    {
+        // unsigned arithmetic wraps instead of overflowing
+        const auto current = static_cast<std::uint64_t>(value);
+        const auto delta = current - m_previous;
+        const auto dod = static_cast<std::int64_t>(delta - m_delta);
+        const auto zigzag = (static_cast<std::uint64_t>(dod) << 1) ^
+            static_cast<std::uint64_t>(dod >> 63);
+        m_previous = current;
+        m_delta = delta;
+        if (zigzag == 0)
+        {
+            writer.write(0, 1);
+            return;
+        }
+        std::size_t form = 0;
+        while (form + 1 < widths.size() &&
+               zigzag >= std::uint64_t{1} << widths[form])
+        {
+            ++form;
+        }
+        // form + 1 one bits, terminated by a zero unless all five are ones
+        const auto ones = static_cast<int>(form + 1);
+        writer.write((std::uint64_t{1} << ones) - 1, std::min(ones + 1, 5));
+        writer.write(zigzag, widths[form]);
+    }
+
+    template <typename Reader>
+    constexpr T
+    decode(Reader& reader) noexcept
+    {
+        int ones = 0;
+        while (ones < 5 && reader.read(1) != 0)
+        {
+            ++ones;
+        }
+        if (ones > 0)
+        {
+            const auto zigzag = reader.read(widths[ones - 1]);
+            const auto dod = (zigzag >> 1) ^ (~(zigzag & 1) + 1);
+            m_delta += dod;
+        }
+        m_previous += m_delta;
+        return static_cast<T>(m_previous);
+    }
+
+    constexpr void
+    reset(const T value) noexcept
+    {
+        m_previous = static_cast<std::uint64_t>(value);
+        m_delta = 0;
+    }
+
+    static constexpr std::uint64_t
+    raw(const T value) noexcept
+    {
+        return static_cast<std::uint64_t>(value);
+    }
+
+    static constexpr T
+    from_raw(const std::uint64_t bits) noexcept
+    {
+        return static_cast<T>(bits);
+    }
+
+private:
+    static constexpr std::array<int, 5> widths{7, 12, 20, 32, 64};
+
+    std::uint64_t m_previous{};
+    std::uint64_t m_delta{};
+};
+
+template <typename T>
+using codec_t = std::
+    conditional_t<std::is_floating_point_v<T>, XorCodec<T>, DeltaCodec<T>>;
+
+} // namespace detail
+
+template <typename BufferType>
+class CompressedIterator;
+
+template <typename BufferType>
+class CompressedReverseIterator;
+
+// A circular buffer of numbers compressed into fixed-size blocks, for long
+// histories of slowly changing values. Floating-point values are XOR
+// encoded, integers delta-of-delta encoded, so repeated values take one bit
+// and smooth series a few:
+//
+//   CompressedCircularBuffer<double, 64> temperatures; // 64 blocks of 256B
+//   temperatures.push_back(21.5);
+//   for (auto it = temperatures.rbegin(); it != temperatures.rend(); ++it)
+//   {
+//       // newest first
+//   }
+//
+// Every block starts with a raw value and decodes independently. A block
+// is closed when it holds BlockValues values or might not fit another
+// value. When all Blocks blocks are in use, appending drops the oldest
+// block as a whole. Iteration decodes sequentially; reverse iteration
+// decodes one block at a time into the iterator.
+template <typename T,
+          std::size_t Blocks,
+          std::size_t BlockBytes = 256,
+          std::size_t BlockValues = 128>
+    requires((std::is_integral_v<T> || std::is_floating_point_v<T>) &&
+             sizeof(T) <= 8 && BlockBytes % 8 == 0 && BlockBytes >= 32 &&
+             BlockBytes * 8 <= UINT16_MAX && BlockValues > 0 &&
+             BlockValues <= UINT16_MAX)
+class CompressedCircularBuffer
+{
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using const_iterator = CompressedIterator<CompressedCircularBuffer>;
+    using const_reverse_iterator =
+        CompressedReverseIterator<CompressedCircularBuffer>;
+
+    static constexpr size_type block_values = BlockValues;
+
+    consteval static size_type
+    max_blocks() noexcept
+    {
+        return Blocks;
+    }
+
+    constexpr size_type
+    size() const noexcept
+    {
+        return m_size;
+    }
+
+    constexpr bool
+    empty() const noexcept
+    {
+        return m_size == 0;
+    }
+
+    // Number of blocks in use.
+    constexpr size_type
+    blocks() const noexcept
+    {
+        return m_blocks.size();
+    }
+
+    constexpr void
+    clear() noexcept
+    {
+        m_blocks.clear();
+        m_back = value_type{};
+        m_size = 0;
+    }
+
+    constexpr value_type
+    front() const noexcept(!detail::checked)
+    {
+        return codec_type::from_raw(m_blocks.front().words[0]);
+    }
+
+    constexpr value_type
+    back() const noexcept(!detail::checked)
+    {
+        CIRCBUF_ASSERT(m_size > 0);
+        return m_back;
+    }
+
+    constexpr void
+    push_back(const value_type value) noexcept
+    {
+        if (m_blocks.empty() || m_blocks.back().count == BlockValues ||
+            m_blocks.back().bits + codec_type::max_bits > block_bits)
+        {
+            if (m_blocks.full())
+            {
+                m_size -= m_blocks.front().count;
+            }
+            m_blocks.push_back(Block{});
+            auto& block = m_blocks.back();
+            block.words[0] = codec_type::raw(value);
+            block.bits = 64;
+            block.count = 1;
+            m_codec.reset(value);
+        }
+        else
+        {
+            auto& block = m_blocks.back();
+            Writer writer{block};
+            m_codec.encode(writer, value);
+            ++block.count;
+        }
+        m_back = value;
+        ++m_size;
+    }
+
+    constexpr const_iterator
+    begin() const noexcept
+    {
+        return const_iterator{*this};
+    }
+
+    constexpr std::default_sentinel_t
+    end() const noexcept
+    {
+        return {};
+    }
+
+    constexpr const_reverse_iterator
+    rbegin() const noexcept
+    {
+        return const_reverse_iterator{*this};
+    }
+
+    constexpr std::default_sentinel_t
+    rend() const noexcept
+    {
+        return {};
+    }
+
+private:
+    template <typename BufferType>
+    friend class CompressedIterator;
+
+    template <typename BufferType>
+    friend class CompressedReverseIterator;
+
+    using codec_type = detail::codec_t<value_type>;
+
+    static constexpr std::size_t block_bits = BlockBytes * 8;
+
+    struct Block
+    {
+        std::array<std::uint64_t, BlockBytes / 8> words;
+        std::uint16_t bits;
+        std::uint16_t count;
+    };
+
+    // Appends bits to a block, least significant first.
+    struct Writer
+    {
+        constexpr void
+        write(const std::uint64_t value, const int count) noexcept
+        {
+            if (count == 0)
+            {
+                return;
+            }
+            const auto offset = block.bits % 64;
+            const auto word = block.bits / 64;
+            const auto masked =
+                count == 64 ? value : value & ((std::uint64_t{1} << count) - 1);
+            block.words[word] |= masked << offset;
+            if (offset + count > 64)
+            {
+                block.words[word + 1] |= masked >> (64 - offset);
+            }
+            block.bits = static_cast<std::uint16_t>(block.bits + count);
+        }
+
+        Block& block;
+    };
+
+    // Reads the bits of a block in the order they were written.
+    struct Reader
+    {
+        constexpr std::uint64_t
+        read(const int count) noexcept
+        {
+            if (count == 0)
+            {
+                return 0;
+            }
+            const auto offset = position % 64;
+            const auto word = position / 64;
+            auto value = block->words[word] >> offset;
+            if (offset + count > 64)
+            {
+                value |= block->words[word + 1] << (64 - offset);
+            }
+            position += static_cast<std::size_t>(count);
+            return count == 64 ? value
+                               : value & ((std::uint64_t{1} << count) - 1);
+        }
+
+        const Block* block{};
+        std::size_t position{64};
+    };
+
+    CircularBuffer<Block, Blocks> m_blocks;
+    codec_type m_codec;
+    value_type m_back{};
+    size_type m_size{};
+};
+
+// Decodes a CompressedCircularBuffer from its oldest value on.
+template <typename BufferType>
+class CompressedIterator
+{
+public:
+    using self_type = CompressedIterator;
+    using value_type = typename BufferType::value_type;
+    using difference_type = std::ptrdiff_t;
+    using reference = value_type;
+    using iterator_category = std::input_iterator_tag;
+
+    constexpr CompressedIterator() = default;
+
+    explicit constexpr CompressedIterator(const BufferType& buffer,
+                                          const std::size_t block = 0) noexcept
+        : m_buffer{&buffer}
+        , m_block{block}
+    {
+        start();
+    }
+
+    constexpr value_type
+    operator*() const noexcept
+    {
+        return m_value;
+    }
+
+    constexpr self_type&
+    operator++() noexcept
+    {
+        if (++m_index == m_buffer->m_blocks[m_block].count)
+        {
+            ++m_block;
+            start();
+        }
+        else
+        {
+            m_value = m_codec.decode(m_reader);
+        }
+        return *this;
+    }
+
+    constexpr self_type
+    operator++(int) noexcept
+    {
+        self_type temp = *this;
+        ++*this;
+        return temp;
+    }
+
+    friend constexpr bool
+    operator==(const self_type& it, std::default_sentinel_t) noexcept
+    {
+        return it.done();
+    }
+
+private:
+    using codec_type = typename BufferType::codec_type;
+
+    constexpr bool
+    done() const noexcept
+    {
+        return m_block == m_buffer->m_blocks.size();
+    }
+
+    constexpr void
+    start() noexcept
+    {
+        if (done())
+        {
+            return;
+        }
+        const auto& block = m_buffer->m_blocks[m_block];
+        m_reader = {&block};
+        m_index = 0;
+        m_value = codec_type::from_raw(block.words[0]);
+        m_codec.reset(m_value);
+    }
+
+    const BufferType* m_buffer{};
+    typename BufferType::Reader m_reader;
+    codec_type m_codec;
+    std::size_t m_block{};
+    std::size_t m_index{};
+    value_type m_value{};
+};
+
+// Decodes a CompressedCircularBuffer from its newest value on. It holds the
+// decoded values of one block.
+template <typename BufferType>
+class CompressedReverseIterator
+{
+public:
+    using self_type = CompressedReverseIterator;
+    using value_type = typename BufferType::value_type;
+    using difference_type = std::ptrdiff_t;
+    using reference = value_type;
+    using iterator_category = std::input_iterator_tag;
+
+    constexpr CompressedReverseIterator() = default;
+
+    explicit constexpr CompressedReverseIterator(
+        const BufferType& buffer) noexcept
+        : m_buffer{&buffer}
+        , m_block{buffer.m_blocks.size()}
+    {
+        load();
+    }
+
+    constexpr value_type
+    operator*() const noexcept
+    {
+        return m_values[m_index - 1];
+    }
+
+    constexpr self_type&
+    operator++() noexcept
+    {
+        if (--m_index == 0)
+        {
+            load();
+        }
+        return *this;
+    }
+
+    constexpr self_type
+    operator++(int) noexcept
+    {
+        self_type temp = *this;
+        ++*this;
+        return temp;
+    }
+
+    friend constexpr bool
+    operator==(const self_type& it, std::default_sentinel_t) noexcept
+    {
+        return it.m_index == 0;
+    }
+
+private:
+    // Decodes the block before the current one, if any.
+    constexpr void
+    load() noexcept
+    {
+        if (m_block == 0)
+        {
+            return;
+        }
+        --m_block;
+        CompressedIterator<BufferType> it{*m_buffer, m_block};
+        m_index = m_buffer->m_blocks[m_block].count;
+        for (std::size_t i = 0; i < m_index; ++i, ++it)
+        {
+            m_values[i] = *it;
+        }
+    }
+
+    const BufferType* m_buffer{};
+    std::size_t m_block{};
+    std::size_t m_index{};
+    std::array<value_type, BufferType::block_values> m_values{};
+};
+
+} // namespace CIRCBUF_ABI_NAMESPACE
+} // namespace circbuf
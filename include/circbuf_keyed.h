@@ -0,0 +1,270 @@
+#pragma once
+
+#include "circbuf.h"
+#include "circbuf_table.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace circbuf
+{
+inline namespace CIRCBUF_ABI_NAMESPACE
+{
+
+// The last MaxSize values for each of many keys, with all rings stored
+// next to each other in one arena instead of one heap block per key:
+//
+//   KeyedCircularBuffer<SymbolId, Trade, 64> trades;
+//   trades.reserve(50000);
+//   trades.push(trade.symbol, trade);
+//   for (const auto& trade : trades.history(symbol))
+//   {
+//       // oldest first
+//   }
+//   trades.for_each([](const SymbolId symbol, const auto& history) {
+//       // one linear walk over the arena
+//   });
+//
+// A key gets a slot of the arena on its first push and keeps it until it
+// is retired, after which the slot is reused by the next new key. Pushing
+// a new key while no slot is free may grow the arena, which invalidates
+// references returned by history and find; reserve avoids that. Keys are
+// located through an open addressing table of arena indices with linear
+// probing, so a lookup touches one flat array before the arena.
+template <typename Key,
+          typename T,
+          std::size_t MaxSize,
+          typename Hash = std::hash<Key>,
+          typename KeyEqual = std::equal_to<Key>>
+class KeyedCircularBuffer
+{
+public:
+    using key_type = Key;
+    using value_type = T;
+    using size_type = std::size_t;
+    using buffer_type = CircularBuffer<T, MaxSize>;
+
+    KeyedCircularBuffer() = default;
+
+    explicit KeyedCircularBuffer(const size_type keys)
+    {
+        reserve(keys);
+    }
+
+    KeyedCircularBuffer(const size_type keys,
+                        Hash hash,
+                        KeyEqual equal = KeyEqual{})
+        : m_table{std::move(hash), std::move(equal)}
+    {
+        reserve(keys);
+    }
+
+    // The number of live keys.
+    size_type
+    size() const noexcept
+    {
+        return m_live;
+    }
+
+    bool
+    empty() const noexcept
+    {
+        return m_live == 0;
+    }
+
+    // The number of slots in the arena, live or free.
+    size_type
+    slots() const noexcept
+    {
+        return m_slots.size();
+    }
+
+    void
+    reserve(const size_type keys)
+    {
+        m_slots.reserve(keys);
+        if (table_size(keys) > m_table.size())
+        {
+            m_table.rehash(table_size(keys), key_of());
+        }
+    }
+
+    bool
+    contains(const key_type& key) const
+    {
+        return locate(key) != none;
+    }
+
+    void
+    push(const key_type& key, const value_type& value)
+    {
+        slot(key).push_back(value);
+    }
+
+    void
+    push(const key_type& key, value_type&& value)
+    {
+        slot(key).push_back(std::move(value));
+    }
+
+    template <typename... Args>
+    void
+    emplace(const key_type& key, Args&&... args)
+    {
+        slot(key).emplace_back(std::forward<Args>(args)...);
+    }
+
+    // The history of key, oldest first. key must be live.
+    const buffer_type&
+    history(const key_type& key) const
+    {
+        const auto index = locate(key);
+        CIRCBUF_ASSERT(index != none);
+        return m_slots[index].buffer;
+    }
+
+    // The history of key or nullptr if key is not live.
+    const buffer_type*
+    find(const key_type& key) const
+    {
+        const auto index = locate(key);
+        return index != none ? &m_slots[index].buffer : nullptr;
+    }
+
+    // Drops the history of key and frees its slot. Returns false if key was
+    // not live.
+    bool
+    retire(const key_type& key)
+    {
+        if (m_table.empty())
+        {
+            return false;
+        }
+        const auto position = probe(key);
+        const auto index = m_table[position];
+        if (index == none)
+        {
+            return false;
+        }
+        m_free.push_back(index);
+        auto& slot = m_slots[index];
+        slot.buffer.clear();
+        slot.live = false;
+        m_table.remove(position, key_of());
+        --m_live;
+        return true;
+    }
+
+    void
+    clear() noexcept
+    {
+        m_slots.clear();
+        m_free.clear();
+        m_table.clear();
+        m_live = 0;
+    }
+
+    // Calls fn(key, history) for every live key in arena order.
+    template <typename Function>
+    void
+    for_each(Function&& fn) const
+    {
+        for (const auto& slot : m_slots)
+        {
+            if (slot.live)
+            {
+                fn(slot.key, slot.buffer);
+            }
+        }
+    }
+
+private:
+    using table_type = detail::
+        OpenAddressingTable<Key, std::vector<size_type>, Hash, KeyEqual>;
+
+    static constexpr size_type none = table_type::none;
+
+    struct Slot
+    {
+        Key key;
+        bool live;
+        buffer_type buffer;
+    };
+
+    // The table is kept at most half full, which keeps probe sequences
+    // short.
+    static size_type
+    table_size(const size_type keys) noexcept
+    {
+        return std::bit_ceil(std::max<size_type>(keys * 2, 16));
+    }
+
+    // Looks up the key of a slot for the table.
+    auto
+    key_of() const noexcept
+    {
+        return [this](const size_type index) -> const key_type& {
+            return m_slots[index].key;
+        };
+    }
+
+    // The table position holding key or, if key is not live, the empty
+    // position where it would be inserted. The table must not be empty.
+    size_type
+    probe(const key_type& key) const
+    {
+        return m_table.probe(key, key_of());
+    }
+
+    // The arena index of key or none if key is not live.
+    size_type
+    locate(const key_type& key) const
+    {
+        return m_table.empty() ? none : m_table[probe(key)];
+    }
+
+    // The ring of key, taking a slot for it if it is not live. Everything
+    // that may throw happens before the key is entered into the table, so
+    // a failure leaves no slot behind that is neither live nor free.
+    buffer_type&
+    slot(const key_type& key)
+    {
+        if (table_size(m_live + 1) > m_table.size())
+        {
+            m_table.rehash(table_size(m_live + 1), key_of());
+        }
+        const auto position = probe(key);
+        if (m_table[position] != none)
+        {
+            return m_slots[m_table[position]].buffer;
+        }
+        size_type index;
+        if (m_free.empty())
+        {
+            index = m_slots.size();
+            m_slots.push_back(Slot{key, true, {}});
+        }
+        else
+        {
+            index = m_free.back();
+            m_slots[index].key = key;
+            m_slots[index].live = true;
+            m_free.pop_back();
+        }
+        m_table[position] = index;
+        ++m_live;
+        return m_slots[index].buffer;
+    }
+
+    std::vector<Slot> m_slots;
+    std::vector<size_type> m_free;
+    table_type m_table;
+    size_type m_live{};
+};
+
+} // namespace CIRCBUF_ABI_NAMESPACE
+} // namespace circbuf
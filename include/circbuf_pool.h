@@ -0,0 +1,240 @@
+#pragma once
+
+#include "circbuf.h"
+#include "circbuf_spsc.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace circbuf
+{
+inline namespace CIRCBUF_ABI_NAMESPACE
+{
+
+// A lock-free bounded queue for any number of producer and consumer
+// threads (Dmitry Vyukov's algorithm). Each slot carries a sequence number
+// telling whether it is ready to be written or read in the current lap, so
+// try_push and try_pop each cost one compare-and-swap when uncontended.
+// Offers the try_push and try_pop of SpscCircularBuffer.
+template <typename T, std::size_t MaxSize>
+    requires(MaxSize > 0 && std::is_default_constructible_v<T>)
+class MpmcCircularBuffer
+{
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+
+    MpmcCircularBuffer() noexcept
+    {
+        for (size_type index = 0; index < MaxSize; ++index)
+        {
+            m_cells[index].sequence.store(index, std::memory_order_relaxed);
+        }
+    }
+
+    MpmcCircularBuffer(const MpmcCircularBuffer&) = delete;
+    MpmcCircularBuffer&
+    operator=(const MpmcCircularBuffer&) = delete;
+
+    consteval static size_type
+    max_size() noexcept
+    {
+        return MaxSize;
+    }
+
+    // Appends value unless the queue is full.
+    template <typename Type>
+    bool
+    try_push(Type&& value) noexcept(
+        std::is_nothrow_assignable_v<value_type&, Type>)
+    {
+        auto position = m_write.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            auto& cell = m_cells[position % MaxSize];
+            const auto sequence = cell.sequence.load(std::memory_order_acquire);
+            if (sequence == position)
+            {
+                if (m_write.compare_exchange_weak(
+                        position, position + 1, std::memory_order_relaxed))
+                {
+                    cell.value = std::forward<Type>(value);
+                    cell.sequence.store(position + 1,
+                                        std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (sequence < position)
+            {
+                return false;
+            }
+            else
+            {
+                position = m_write.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Removes and returns the front element unless the queue is empty.
+    std::optional<value_type>
+    try_pop() noexcept(std::is_nothrow_move_constructible_v<value_type>)
+    {
+        auto position = m_read.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            auto& cell = m_cells[position % MaxSize];
+            const auto sequence = cell.sequence.load(std::memory_order_acquire);
+            if (sequence == position + 1)
+            {
+                if (m_read.compare_exchange_weak(
+                        position, position + 1, std::memory_order_relaxed))
+                {
+                    std::optional<value_type> value{std::move(cell.value)};
+                    cell.sequence.store(position + MaxSize,
+                                        std::memory_order_release);
+                    return value;
+                }
+            }
+            else if (sequence < position + 1)
+            {
+                return std::nullopt;
+            }
+            else
+            {
+                position = m_read.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+private:
+    struct Cell
+    {
+        std::atomic<size_type> sequence;
+        value_type value{};
+    };
+
+    alignas(detail::cache_line_size) std::atomic<size_type> m_write{};
+    alignas(detail::cache_line_size) std::atomic<size_type> m_read{};
+    alignas(detail::cache_line_size) std::array<Cell, MaxSize> m_cells;
+};
+
+// A fixed pool of Capacity objects of type T kept in inline aligned
+// storage. The indices of free slots circulate through Ring, a queue of
+// detail::index_t<Capacity> holding at least Capacity elements, so
+// acquiring an object is one pop and releasing it one push:
+//
+//   SpscObjectPool<Message, 1024> pool;
+//
+//   // decoder
+//   Message* message = pool.acquire();
+//   decode(packet, *message);
+//   queue.try_push(message);
+//
+//   // sender
+//   send(*message);
+//   pool.release(message);
+//
+// acquire constructs the object in place and returns nullptr when all
+// objects are in use; release destroys it. With SpscObjectPool one thread
+// may acquire and one other thread may release; MpmcObjectPool allows any
+// number of both. Objects still in use when the pool is destroyed are not
+// destroyed.
+template <typename T, std::size_t Capacity, typename Ring>
+    requires(Capacity > 0 && Ring::max_size() >= Capacity)
+class BasicObjectPool
+{
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+
+    BasicObjectPool() noexcept
+    {
+        for (size_type index = 0; index < Capacity; ++index)
+        {
+            m_free.try_push(static_cast<index_type>(index));
+        }
+    }
+
+    BasicObjectPool(const BasicObjectPool&) = delete;
+    BasicObjectPool&
+    operator=(const BasicObjectPool&) = delete;
+
+    consteval static size_type
+    capacity() noexcept
+    {
+        return Capacity;
+    }
+
+    // Constructs an object from args in a free slot. Returns nullptr if no
+    // slot is free.
+    template <typename... Args>
+        requires std::is_nothrow_constructible_v<value_type, Args...>
+    value_type*
+    acquire(Args&&... args) noexcept
+    {
+        const auto index = m_free.try_pop();
+        if (!index)
+        {
+            return nullptr;
+        }
+        return std::construct_at(
+            reinterpret_cast<value_type*>(m_slots[*index].bytes),
+            std::forward<Args>(args)...);
+    }
+
+    // Destroys an object returned by acquire and frees its slot.
+    void
+    release(value_type* const object) noexcept(
+        !detail::checked && std::is_nothrow_destructible_v<value_type>)
+    {
+        CIRCBUF_ASSERT(owns(object));
+        const auto index = static_cast<index_type>(
+            (reinterpret_cast<const std::byte*>(object) -
+             reinterpret_cast<const std::byte*>(m_slots.data())) /
+            sizeof(Slot));
+        std::destroy_at(object);
+        m_free.try_push(index);
+    }
+
+    // Whether object points into the storage of this pool.
+    bool
+    owns(const value_type* const object) const noexcept
+    {
+        const auto address = reinterpret_cast<std::uintptr_t>(object);
+        const auto first = reinterpret_cast<std::uintptr_t>(m_slots.data());
+        return address >= first && address < first + sizeof(m_slots) &&
+            (address - first) % sizeof(Slot) == 0;
+    }
+
+private:
+    using index_type = detail::index_t<Capacity>;
+
+    struct Slot
+    {
+        alignas(value_type) std::byte bytes[sizeof(value_type)];
+    };
+
+    std::array<Slot, Capacity> m_slots;
+    Ring m_free;
+};
+
+template <typename T, std::size_t Capacity>
+using SpscObjectPool = BasicObjectPool<
+    T,
+    Capacity,
+    SpscCircularBuffer<detail::index_t<Capacity>, Capacity>>;
+
+template <typename T, std::size_t Capacity>
+using MpmcObjectPool = BasicObjectPool<
+    T,
+    Capacity,
+    MpmcCircularBuffer<detail::index_t<Capacity>, Capacity>>;
+
+} // namespace CIRCBUF_ABI_NAMESPACE
+} // namespace circbuf
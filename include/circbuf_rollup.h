@@ -0,0 +1,299 @@
+#pragma once
+
+#include "circbuf.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace circbuf
+{
+inline namespace CIRCBUF_ABI_NAMESPACE
+{
+
+// The consolidated samples of one interval.
+template <typename T, typename TimePoint>
+struct Rollup
+{
+    using value_type = T;
+    using time_point = TimePoint;
+
+    // The mean of the samples. The rollup must not be empty.
+    constexpr T
+    average() const noexcept(!detail::checked)
+    {
+        CIRCBUF_ASSERT(count > 0);
+        return sum / static_cast<T>(count);
+    }
+
+    constexpr void
+    add(const T value) noexcept
+    {
+        if (count == 0)
+        {
+            min = value;
+            max = value;
+            sum = value;
+        }
+        else
+        {
+            min = std::min(min, value);
+            max = std::max(max, value);
+            sum += value;
+        }
+        last = value;
+        ++count;
+    }
+
+    constexpr void
+    merge(const Rollup& other) noexcept
+    {
+        if (count == 0)
+        {
+            min = other.min;
+            max = other.max;
+            sum = other.sum;
+        }
+        else
+        {
+            min = std::min(min, other.min);
+            max = std::max(max, other.max);
+            sum += other.sum;
+        }
+        last = other.last;
+        count += other.count;
+    }
+
+    // Start of the interval.
+    time_point start{};
+    T min{};
+    T max{};
+    T sum{};
+    T last{};
+    std::uint64_t count{};
+};
+
+// A range of consolidated intervals of one level of a RollupBuffer.
+template <typename BufferType>
+struct RollupRange
+{
+    using const_iterator = typename BufferType::const_iterator;
+
+    constexpr const_iterator
+    begin() const noexcept
+    {
+        return first;
+    }
+
+    constexpr const_iterator
+    end() const noexcept
+    {
+        return last;
+    }
+
+    constexpr bool
+    empty() const noexcept
+    {
+        return first == last;
+    }
+
+    std::size_t level;
+    const_iterator first;
+    const_iterator last;
+};
+
+// Round-robin database style aggregates of a series at Levels resolutions,
+// each keeping the last Slots intervals:
+//
+//   using namespace std::chrono_literals;
+//   RollupBuffer<double, 1440, 3> latency{{1s, 1min, 1h}};
+//   latency.add(now, value);
+//   for (const auto& rollup : latency.query(now - 6h, now, 1min))
+//   {
+//       plot(rollup.start, rollup.average(), rollup.max);
+//   }
+//
+// Samples are added to the open interval of the finest level. Once a
+// sample falls past the open interval of a level, that interval is
+// completed: it is appended to its level's ring and merged into the open
+// interval of the next coarser level, finest level first. Every interval
+// must be a multiple of the finer one and timestamps must not decrease.
+// Intervals are aligned to multiples of their length since TimePoint{}.
+template <typename T,
+          std::size_t Slots,
+          std::size_t Levels,
+          typename TimePoint = std::chrono::system_clock::time_point>
+    requires(Levels > 0)
+class RollupBuffer
+{
+public:
+    using value_type = T;
+    using time_point = TimePoint;
+    using duration =
+        decltype(std::declval<time_point>() - std::declval<time_point>());
+    using rollup_type = Rollup<T, TimePoint>;
+    using buffer_type = CircularBuffer<rollup_type, Slots>;
+    using range_type = RollupRange<buffer_type>;
+    using size_type = std::size_t;
+
+    // intervals are ordered from the finest to the coarsest.
+    constexpr explicit RollupBuffer(
+        const std::array<duration, Levels>& intervals)
+        : m_intervals{intervals}
+    {
+        for (size_type level = 1; level < Levels; ++level)
+        {
+            CIRCBUF_ASSERT(intervals[level] % intervals[level - 1] ==
+                           duration{});
+        }
+    }
+
+    consteval static size_type
+    levels() noexcept
+    {
+        return Levels;
+    }
+
+    constexpr duration
+    interval(const size_type level) const noexcept
+    {
+        return m_intervals[level];
+    }
+
+    // The completed intervals of a level, oldest first.
+    constexpr const buffer_type&
+    level(const size_type level) const noexcept
+    {
+        return m_levels[level];
+    }
+
+    // The interval of a level still being filled. Its count is zero if no
+    // sample has reached it yet.
+    constexpr const rollup_type&
+    current(const size_type level) const noexcept
+    {
+        return m_open[level];
+    }
+
+    constexpr void
+    clear() noexcept
+    {
+        for (size_type level = 0; level < Levels; ++level)
+        {
+            m_levels[level].clear();
+            m_open[level] = {};
+        }
+    }
+
+    constexpr void
+    add(const time_point time, const value_type value) noexcept
+    {
+        for (size_type level = 0; level < Levels; ++level)
+        {
+            if (m_open[level].count > 0 &&
+                m_open[level].start != align(level, time))
+            {
+                complete(level);
+            }
+        }
+        if (m_open[0].count == 0)
+        {
+            m_open[0].start = align(0, time);
+        }
+        m_open[0].add(value);
+    }
+
+    // Completes the open intervals of all levels, e.g. before shutting
+    // down.
+    constexpr void
+    flush() noexcept
+    {
+        for (size_type level = 0; level < Levels; ++level)
+        {
+            if (m_open[level].count > 0)
+            {
+                complete(level);
+            }
+        }
+    }
+
+    // The completed intervals overlapping [from, to) at the coarsest level
+    // whose interval does not exceed step, or the finest level if none
+    // does. If that level does not reach back to from, the next coarser
+    // level that does is used, or the coarsest one.
+    constexpr range_type
+    query(const time_point from,
+          const time_point to,
+          const duration step) const noexcept
+    {
+        size_type level = 0;
+        while (level + 1 < Levels && !(step < m_intervals[level + 1]))
+        {
+            ++level;
+        }
+        while (level + 1 < Levels && (m_levels[level].empty() ||
+                                      from < m_levels[level].front().start))
+        {
+            ++level;
+        }
+        const auto& rollups = m_levels[level];
+        const auto length = m_intervals[level];
+        const auto first = std::partition_point(
+            rollups.begin(), rollups.end(), [&](const rollup_type& rollup) {
+                return !(from < rollup.start + length);
+            });
+        const auto last = std::partition_point(
+            first, rollups.end(), [&](const rollup_type& rollup) {
+                return rollup.start < to;
+            });
+        return {level, first, last};
+    }
+
+    // The consolidation of the intervals returned by query.
+    constexpr rollup_type
+    aggregate(const time_point from,
+              const time_point to,
+              const duration step) const noexcept
+    {
+        rollup_type result{from};
+        for (const auto& rollup : query(from, to, step))
+        {
+            result.merge(rollup);
+        }
+        return result;
+    }
+
+private:
+    constexpr time_point
+    align(const size_type level, const time_point time) const noexcept
+    {
+        const auto length = m_intervals[level];
+        return time_point{} + (time - time_point{}) / length * length;
+    }
+
+    constexpr void
+    complete(const size_type level) noexcept
+    {
+        const auto rollup = std::exchange(m_open[level], rollup_type{});
+        m_levels[level].push_back(rollup);
+        if (level + 1 < Levels)
+        {
+            auto& next = m_open[level + 1];
+            if (next.count == 0)
+            {
+                next.start = align(level + 1, rollup.start);
+            }
+            next.merge(rollup);
+        }
+    }
+
+    std::array<duration, Levels> m_intervals;
+    std::array<buffer_type, Levels> m_levels;
+    std::array<rollup_type, Levels> m_open;
+};
+
+} // namespace CIRCBUF_ABI_NAMESPACE
+} // namespace circbuf
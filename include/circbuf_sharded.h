@@ -0,0 +1,327 @@
+#pragma once
+
+#include "circbuf.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+
+namespace circbuf
+{
+inline namespace CIRCBUF_ABI_NAMESPACE
+{
+
+namespace detail
+{
+
+// A number identifying the calling thread, assigned in order of first use.
+inline std::size_t
+thread_number() noexcept
+{
+    static std::atomic<std::size_t> next{};
+    thread_local const std::size_t number =
+        next.fetch_add(1, std::memory_order_relaxed);
+    return number;
+}
+
+} // namespace detail
+
+template <typename BufferType, std::size_t Shards, typename Compare>
+class MergeIterator;
+
+// A set of Shards circular buffers written concurrently. Each thread
+// pushes into its own shard, so writers on different threads only contend
+// if there are more threads than shards. Readers either visit the shards in
+// place or take a snapshot and merge it:
+//
+//   ShardedCircularBuffer<Sample, 1024, 64> samples;
+//   samples.push_back(sample); // from any thread
+//
+//   using Snapshot = decltype(samples)::snapshot_type;
+//   auto snapshot = std::make_unique<Snapshot>(); // allocate once, reuse
+//   samples.snapshot(*snapshot);
+//   auto by_time = [](const Sample& a, const Sample& b) {
+//       return a.time < b.time;
+//   };
+//   for (const auto& sample : merge(*snapshot, by_time)) { ... }
+//
+// Every shard keeps its most recent MaxSize elements.
+template <typename T, std::size_t MaxSize, std::size_t Shards>
+    requires(Shards > 0)
+class ShardedCircularBuffer
+{
+public:
+    using buffer_type = CircularBuffer<T, MaxSize>;
+    using value_type = typename buffer_type::value_type;
+    using size_type = typename buffer_type::size_type;
+    using snapshot_type = std::array<buffer_type, Shards>;
+
+    consteval static size_type
+    shard_count() noexcept
+    {
+        return Shards;
+    }
+
+    consteval static size_type
+    max_size() noexcept
+    {
+        return MaxSize * Shards;
+    }
+
+    // The shard the calling thread pushes into.
+    static size_type
+    this_shard() noexcept
+    {
+        return detail::thread_number() % Shards;
+    }
+
+    size_type
+    size() const
+    {
+        size_type size{};
+        for (auto& shard : m_shards)
+        {
+            std::lock_guard lock{shard.mutex};
+            size += shard.buffer.size();
+        }
+        return size;
+    }
+
+    void
+    clear()
+    {
+        for (auto& shard : m_shards)
+        {
+            std::lock_guard lock{shard.mutex};
+            shard.buffer.clear();
+        }
+    }
+
+    void
+    push_back(const value_type& value)
+    {
+        emplace_back_to(this_shard(), value);
+    }
+
+    void
+    push_back(value_type&& value)
+    {
+        emplace_back_to(this_shard(), std::move(value));
+    }
+
+    template <typename... Args>
+    void
+    emplace_back(Args&&... args)
+    {
+        emplace_back_to(this_shard(), std::forward<Args>(args)...);
+    }
+
+    // Appends to a chosen shard, e.g. one per CPU.
+    template <typename... Args>
+    void
+    emplace_back_to(const size_type shard, Args&&... args)
+    {
+        auto& target = m_shards[shard];
+        std::lock_guard lock{target.mutex};
+        target.buffer.emplace_back(std::forward<Args>(args)...);
+    }
+
+    // Calls function with every shard's buffer in turn while holding that
+    // shard's lock.
+    template <typename Function>
+    void
+    for_each_shard(Function function) const
+    {
+        for (auto& shard : m_shards)
+        {
+            std::lock_guard lock{shard.mutex};
+            function(std::as_const(shard.buffer));
+        }
+    }
+
+    // Copies every shard into snapshot. Shards are copied one at a time, so
+    // the snapshot is consistent per shard only. A snapshot_type holds all
+    // shards inline, which is too large for the stack in most
+    // configurations, so keep one on the heap and reuse it.
+    void
+    snapshot(snapshot_type& snapshot) const
+    {
+        for (size_type i = 0; i < Shards; ++i)
+        {
+            std::lock_guard lock{m_shards[i].mutex};
+            snapshot[i] = m_shards[i].buffer;
+        }
+    }
+
+private:
+    struct alignas(detail::cache_line_size) Shard
+    {
+        mutable std::mutex mutex;
+        buffer_type buffer;
+    };
+
+    std::array<Shard, Shards> m_shards;
+};
+
+// The elements of several buffers merged into the order given by Compare
+// through a k-way merge. If every buffer is ordered, so is the merged
+// sequence; equivalent elements keep the order of their buffers.
+template <typename BufferType, std::size_t Shards, typename Compare>
+class MergeRange
+{
+public:
+    using iterator = MergeIterator<BufferType, Shards, Compare>;
+
+    constexpr MergeRange(const std::array<BufferType, Shards>& buffers,
+                         Compare compare)
+        : m_buffers{&buffers}
+        , m_compare{std::move(compare)}
+    {
+    }
+
+    constexpr iterator
+    begin() const
+    {
+        return iterator{*m_buffers, m_compare};
+    }
+
+    constexpr std::default_sentinel_t
+    end() const noexcept
+    {
+        return {};
+    }
+
+private:
+    const std::array<BufferType, Shards>* m_buffers;
+    Compare m_compare;
+};
+
+template <typename BufferType,
+          std::size_t Shards,
+          typename Compare = std::less<>>
+constexpr MergeRange<BufferType, Shards, Compare>
+merge(const std::array<BufferType, Shards>& buffers, Compare compare = {})
+{
+    return {buffers, std::move(compare)};
+}
+
+// Walks several buffers in merged order. It keeps a binary heap of the
+// buffers' next elements, so each step takes O(log Shards) comparisons.
+template <typename BufferType, std::size_t Shards, typename Compare>
+class MergeIterator
+{
+public:
+    using self_type = MergeIterator;
+    using value_type = typename BufferType::value_type;
+    using size_type = typename BufferType::size_type;
+    using difference_type = typename BufferType::difference_type;
+    using reference = typename BufferType::const_reference;
+    using pointer = const value_type*;
+    using iterator_category = std::input_iterator_tag;
+
+    constexpr MergeIterator() = default;
+
+    constexpr MergeIterator(const std::array<BufferType, Shards>& buffers,
+                            Compare compare)
+        : m_buffers{&buffers}
+        , m_compare{std::move(compare)}
+    {
+        for (size_type i = 0; i < Shards; ++i)
+        {
+            if (!buffers[i].empty())
+            {
+                m_heap[m_heap_size++] = i;
+            }
+        }
+        std::make_heap(m_heap.begin(), m_heap.begin() + m_heap_size, later());
+    }
+
+    constexpr reference
+    operator*() const noexcept
+    {
+        return current(m_heap[0]);
+    }
+
+    constexpr pointer
+    operator->() const noexcept
+    {
+        return &**this;
+    }
+
+    // The buffer holding the current element.
+    constexpr size_type
+    shard() const noexcept
+    {
+        return m_heap[0];
+    }
+
+    constexpr self_type&
+    operator++()
+    {
+        const auto first = m_heap.begin();
+        const auto last = first + m_heap_size;
+        std::pop_heap(first, last, later());
+        const auto buffer = m_heap[m_heap_size - 1];
+        if (++m_positions[buffer] == (*m_buffers)[buffer].size())
+        {
+            --m_heap_size;
+        }
+        else
+        {
+            std::push_heap(first, last, later());
+        }
+        return *this;
+    }
+
+    constexpr self_type
+    operator++(int)
+    {
+        self_type temp = *this;
+        ++*this;
+        return temp;
+    }
+
+    friend constexpr bool
+    operator==(const self_type& it, std::default_sentinel_t) noexcept
+    {
+        return it.m_heap_size == 0;
+    }
+
+private:
+    constexpr reference
+    current(const size_type buffer) const noexcept
+    {
+        return (*m_buffers)[buffer][m_positions[buffer]];
+    }
+
+    // Orders the heap so that its top holds the buffer whose next element
+    // comes first, preferring lower buffers among equivalent elements.
+    constexpr auto
+    later() const
+    {
+        return [this](const size_type lhs, const size_type rhs) {
+            const auto& left = current(lhs);
+            const auto& right = current(rhs);
+            if (std::invoke(m_compare, right, left))
+            {
+                return true;
+            }
+            return !std::invoke(m_compare, left, right) && rhs < lhs;
+        };
+    }
+
+    const std::array<BufferType, Shards>* m_buffers{};
+    Compare m_compare{};
+    std::array<size_type, Shards> m_positions{};
+    std::array<size_type, Shards> m_heap{};
+    size_type m_heap_size{};
+};
+
+} // namespace CIRCBUF_ABI_NAMESPACE
+} // namespace circbuf
@@ -0,0 +1,433 @@
+#pragma once
+
+#include "circbuf.h"
+
+#include <array>
+#include <cstddef>
+#include <iterator>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace circbuf
+{
+inline namespace CIRCBUF_ABI_NAMESPACE
+{
+
+template <typename BufferType>
+class SoaCircularBufferIterator;
+
+// A circular buffer of records whose fields are stored in parallel arrays
+// (structure of arrays) sharing a single head and size. Rows are accessed
+// through tuples of references, columns through contiguous spans:
+//
+//   SoaCircularBuffer<1024, std::int64_t, double, int> ticks;
+//   ticks.push_back(timestamp, price, size);
+//   auto [ts, px, sz] = ticks.back();
+//   for (auto segment : ticks.column<1>())
+//   {
+//       sum = std::accumulate(segment.begin(), segment.end(), sum);
+//   }
+//
+// All fields must be default constructible. Slots outside of the occupied
+// range hold default constructed or moved-from values.
+template <std::size_t MaxSize, typename... Fields>
+    requires(MaxSize > 0 && sizeof...(Fields) > 0 &&
+             (std::is_default_constructible_v<Fields> && ...))
+class SoaCircularBuffer
+{
+public:
+    using value_type = std::tuple<Fields...>;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = std::tuple<Fields&...>;
+    using const_reference = std::tuple<const Fields&...>;
+    using iterator = SoaCircularBufferIterator<SoaCircularBuffer>;
+    using const_iterator = SoaCircularBufferIterator<const SoaCircularBuffer>;
+
+    template <std::size_t Index>
+    using field_type = std::tuple_element_t<Index, value_type>;
+
+    consteval static size_type
+    max_size() noexcept
+    {
+        return MaxSize;
+    }
+
+    constexpr size_type
+    size() const noexcept
+    {
+        return m_size;
+    }
+
+    constexpr bool
+    empty() const noexcept
+    {
+        return m_size == 0;
+    }
+
+    constexpr bool
+    full() const noexcept
+    {
+        return m_size == MaxSize;
+    }
+
+    constexpr void
+    clear() noexcept
+    {
+        m_size = 0;
+        m_head = 0;
+    }
+
+    constexpr reference
+    operator[](const size_type index) noexcept(!detail::checked)
+    {
+        CIRCBUF_ASSERT(index < m_size);
+        return row(physical(index));
+    }
+
+    constexpr const_reference
+    operator[](const size_type index) const noexcept(!detail::checked)
+    {
+        CIRCBUF_ASSERT(index < m_size);
+        return row(physical(index));
+    }
+
+    constexpr reference
+    front() noexcept(!detail::checked)
+    {
+        CIRCBUF_ASSERT(!empty());
+        return row(m_head);
+    }
+
+    constexpr const_reference
+    front() const noexcept(!detail::checked)
+    {
+        CIRCBUF_ASSERT(!empty());
+        return row(m_head);
+    }
+
+    constexpr reference
+    back() noexcept(!detail::checked)
+    {
+        CIRCBUF_ASSERT(!empty());
+        return row(physical(m_size - 1));
+    }
+
+    constexpr const_reference
+    back() const noexcept(!detail::checked)
+    {
+        CIRCBUF_ASSERT(!empty());
+        return row(physical(m_size - 1));
+    }
+
+    // The field Column of the element at index.
+    template <std::size_t Column>
+    constexpr field_type<Column>&
+    get(const size_type index) noexcept(!detail::checked)
+    {
+        CIRCBUF_ASSERT(index < m_size);
+        return std::get<Column>(m_columns)[physical(index)];
+    }
+
+    template <std::size_t Column>
+    constexpr const field_type<Column>&
+    get(const size_type index) const noexcept(!detail::checked)
+    {
+        CIRCBUF_ASSERT(index < m_size);
+        return std::get<Column>(m_columns)[physical(index)];
+    }
+
+    // The occupied part of the field Column as up to two contiguous
+    // segments in logical order. The second segment is empty unless the
+    // occupied range wraps around the end of the storage.
+    template <std::size_t Column>
+    constexpr std::array<std::span<field_type<Column>>, 2>
+    column() noexcept
+    {
+        return segments(std::get<Column>(m_columns));
+    }
+
+    template <std::size_t Column>
+    constexpr std::array<std::span<const field_type<Column>>, 2>
+    column() const noexcept
+    {
+        return segments(std::get<Column>(m_columns));
+    }
+
+    template <typename... Type>
+        requires(sizeof...(Type) == sizeof...(Fields))
+    constexpr void
+    push_back(Type&&... value) noexcept(
+        (std::is_nothrow_assignable_v<Fields&, Type> && ...))
+    {
+        increment();
+        const auto index = physical(m_size - 1);
+        assign(index,
+               std::index_sequence_for<Fields...>{},
+               std::forward<Type>(value)...);
+    }
+
+    constexpr void
+    push_back(const value_type& value) noexcept(
+        (std::is_nothrow_copy_assignable_v<Fields> && ...))
+    {
+        std::apply(
+            [this](const auto&... field) { push_back(field...); }, value);
+    }
+
+    constexpr value_type
+    pop_front() noexcept(
+        !detail::checked &&
+        (std::is_nothrow_move_constructible_v<Fields> && ...))
+    {
+        CIRCBUF_ASSERT(!empty());
+        const auto index = m_head;
+        m_head = next(m_head);
+        --m_size;
+        return std::apply(
+            [](auto&... field) { return value_type{std::move(field)...}; },
+            row(index));
+    }
+
+    constexpr iterator
+    begin() noexcept
+    {
+        return iterator{*this, 0};
+    }
+
+    constexpr const_iterator
+    begin() const noexcept
+    {
+        return const_iterator{*this, 0};
+    }
+
+    constexpr const_iterator
+    cbegin() const noexcept
+    {
+        return const_iterator{*this, 0};
+    }
+
+    constexpr iterator
+    end() noexcept
+    {
+        return iterator{*this, m_size};
+    }
+
+    constexpr const_iterator
+    end() const noexcept
+    {
+        return const_iterator{*this, m_size};
+    }
+
+    constexpr const_iterator
+    cend() const noexcept
+    {
+        return const_iterator{*this, m_size};
+    }
+
+private:
+    using index_type = detail::index_t<MaxSize>;
+
+    static constexpr index_type
+    next(const index_type index) noexcept
+    {
+        return index + 1 == MaxSize ? 0 : static_cast<index_type>(index + 1);
+    }
+
+    constexpr size_type
+    physical(const size_type index) const noexcept
+    {
+        const size_type position = m_head + index;
+        return position >= MaxSize ? position - MaxSize : position;
+    }
+
+    constexpr reference
+    row(const size_type index) noexcept
+    {
+        return std::apply(
+            [index](auto&... column) { return reference{column[index]...}; },
+            m_columns);
+    }
+
+    constexpr const_reference
+    row(const size_type index) const noexcept
+    {
+        return std::apply(
+            [index](const auto&... column) {
+                return const_reference{column[index]...};
+            },
+            m_columns);
+    }
+
+    template <std::size_t... Column, typename... Type>
+    constexpr void
+    assign(const size_type index,
+           std::index_sequence<Column...>,
+           Type&&... value)
+    {
+        ((std::get<Column>(m_columns)[index] = std::forward<Type>(value)),
+         ...);
+    }
+
+    template <typename Array>
+    constexpr auto
+    segments(Array& column) const noexcept
+    {
+        using Element = std::remove_reference_t<decltype(column[0])>;
+        const size_type first = std::min<size_type>(m_size, MaxSize - m_head);
+        return std::array<std::span<Element>, 2>{
+            std::span<Element>{column.data() + m_head, first},
+            std::span<Element>{column.data(), m_size - first}};
+    }
+
+    constexpr void
+    increment() noexcept
+    {
+        if (full())
+        {
+            m_head = next(m_head);
+        }
+        else
+        {
+            ++m_size;
+        }
+    }
+
+    template <typename BufferType>
+    friend class SoaCircularBufferIterator;
+
+    std::tuple<std::array<Fields, MaxSize>...> m_columns{};
+    index_type m_size{};
+    index_type m_head{};
+};
+
+// Iterates the rows of a SoaCircularBuffer. Dereferencing yields a tuple of
+// references, so the iterator models std::random_access_iterator only where
+// the standard library provides common references for tuples (C++23).
+template <typename BufferType>
+class SoaCircularBufferIterator
+{
+public:
+    using self_type = SoaCircularBufferIterator;
+    using value_type = typename BufferType::value_type;
+    using size_type = typename BufferType::size_type;
+    using difference_type = typename BufferType::difference_type;
+    using reference =
+        std::conditional_t<std::is_const_v<BufferType>,
+                           typename BufferType::const_reference,
+                           typename BufferType::reference>;
+    using iterator_category = std::input_iterator_tag;
+    using iterator_concept = std::random_access_iterator_tag;
+
+    constexpr SoaCircularBufferIterator() = default;
+
+    explicit constexpr SoaCircularBufferIterator(BufferType& buffer,
+                                                 const size_type index)
+        : m_buffer{&buffer}
+        , m_index{static_cast<difference_type>(index)}
+    {
+    }
+
+    constexpr reference
+    operator*() const noexcept(!detail::checked)
+    {
+        return (*m_buffer)[static_cast<size_type>(m_index)];
+    }
+
+    constexpr reference
+    operator[](const difference_type offset) const noexcept(!detail::checked)
+    {
+        return *(*this + offset);
+    }
+
+    constexpr self_type&
+    operator++() noexcept
+    {
+        ++m_index;
+        return *this;
+    }
+
+    constexpr self_type
+    operator++(int) noexcept
+    {
+        self_type temp = *this;
+        ++*this;
+        return temp;
+    }
+
+    constexpr self_type&
+    operator--() noexcept
+    {
+        --m_index;
+        return *this;
+    }
+
+    constexpr self_type
+    operator--(int) noexcept
+    {
+        self_type temp = *this;
+        --*this;
+        return temp;
+    }
+
+    constexpr self_type&
+    operator+=(const difference_type offset) noexcept
+    {
+        m_index += offset;
+        return *this;
+    }
+
+    constexpr self_type&
+    operator-=(const difference_type offset) noexcept
+    {
+        m_index -= offset;
+        return *this;
+    }
+
+    constexpr self_type
+    operator+(const difference_type offset) const noexcept
+    {
+        self_type temp = *this;
+        return temp += offset;
+    }
+
+    friend constexpr self_type
+    operator+(const difference_type offset, const self_type& it) noexcept
+    {
+        return it + offset;
+    }
+
+    constexpr self_type
+    operator-(const difference_type offset) const noexcept
+    {
+        self_type temp = *this;
+        return temp -= offset;
+    }
+
+    friend constexpr difference_type
+    operator-(const self_type& lhs, const self_type& rhs) noexcept
+    {
+        return lhs.m_index - rhs.m_index;
+    }
+
+    friend constexpr bool
+    operator==(const self_type& lhs, const self_type& rhs) noexcept
+    {
+        return lhs.m_index == rhs.m_index;
+    }
+
+    friend constexpr auto
+    operator<=>(const self_type& lhs, const self_type& rhs) noexcept
+    {
+        return lhs.m_index <=> rhs.m_index;
+    }
+
+private:
+    BufferType* m_buffer{};
+    difference_type m_index{};
+};
+
+} // namespace CIRCBUF_ABI_NAMESPACE
+} // namespace circbuf
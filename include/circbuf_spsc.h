@@ -0,0 +1,173 @@
+#pragma once
+
+#include "circbuf.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+namespace circbuf
+{
+inline namespace CIRCBUF_ABI_NAMESPACE
+{
+
+// A lock-free bounded queue for one producer thread and one consumer thread.
+// Besides single-element try_push and try_pop it transfers batches with one
+// atomic store per batch:
+//
+//   SpscCircularBuffer<Message, 4096> queue;
+//
+//   // producer
+//   auto slots = queue.claim(packet.size());
+//   auto written = decode(packet, slots); // fills slots[0], then slots[1]
+//   queue.publish(written);
+//
+//   // consumer
+//   auto ready = queue.peek_batch(64);
+//   auto handled = handle(ready);
+//   queue.consume(handled);
+//
+// claim and peek_batch return up to two spans in logical order. The second
+// span is empty unless the range wraps around the end of the storage.
+// Elements live in a std::array, so T must be default constructible;
+// slots outside of the occupied range hold default constructed or
+// moved-from values.
+template <typename T, std::size_t MaxSize>
+    requires(MaxSize > 0 && std::is_default_constructible_v<T>)
+class SpscCircularBuffer
+{
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using segments = std::array<std::span<value_type>, 2>;
+
+    consteval static size_type
+    max_size() noexcept
+    {
+        return MaxSize;
+    }
+
+    // Number of published and not yet consumed elements. Exact only when
+    // neither side is active. The read position is loaded first: both
+    // positions only grow and the read position never passes the write
+    // position, so a third thread never sees read > write. The write
+    // position may have moved on by more than MaxSize meanwhile, though.
+    size_type
+    size() const noexcept
+    {
+        const auto read = m_read.load(std::memory_order_acquire);
+        const auto write = m_write.load(std::memory_order_acquire);
+        return std::min<size_type>(write - read, MaxSize);
+    }
+
+    bool
+    empty() const noexcept
+    {
+        return size() == 0;
+    }
+
+    // Producer: up to count free slots to write into. Fewer are returned if
+    // the queue does not have room for count elements.
+    segments
+    claim(const size_type count) noexcept
+    {
+        const auto write = m_write.load(std::memory_order_relaxed);
+        auto free = MaxSize - (write - m_read_cache);
+        if (free < count)
+        {
+            m_read_cache = m_read.load(std::memory_order_acquire);
+            free = MaxSize - (write - m_read_cache);
+        }
+        return span(write, std::min(count, free));
+    }
+
+    // Producer: makes the first count claimed slots visible to the
+    // consumer.
+    void
+    publish(const size_type count) noexcept
+    {
+        m_write.store(m_write.load(std::memory_order_relaxed) + count,
+                      std::memory_order_release);
+    }
+
+    // Producer: appends value unless the queue is full.
+    template <typename Type>
+    bool
+    try_push(Type&& value) noexcept(
+        std::is_nothrow_assignable_v<value_type&, Type>)
+    {
+        const auto slots = claim(1);
+        if (slots[0].empty())
+        {
+            return false;
+        }
+        slots[0][0] = std::forward<Type>(value);
+        publish(1);
+        return true;
+    }
+
+    // Consumer: up to max published elements, oldest first.
+    segments
+    peek_batch(const size_type max) noexcept
+    {
+        const auto read = m_read.load(std::memory_order_relaxed);
+        auto available = m_write_cache - read;
+        if (available < max)
+        {
+            m_write_cache = m_write.load(std::memory_order_acquire);
+            available = m_write_cache - read;
+        }
+        return span(read, std::min(max, available));
+    }
+
+    // Consumer: releases the first count peeked elements to the producer.
+    void
+    consume(const size_type count) noexcept
+    {
+        m_read.store(m_read.load(std::memory_order_relaxed) + count,
+                     std::memory_order_release);
+    }
+
+    // Consumer: removes the front element unless the queue is empty.
+    std::optional<value_type>
+    try_pop() noexcept(std::is_nothrow_move_constructible_v<value_type>)
+    {
+        const auto elements = peek_batch(1);
+        if (elements[0].empty())
+        {
+            return std::nullopt;
+        }
+        std::optional<value_type> value{std::move(elements[0][0])};
+        consume(1);
+        return value;
+    }
+
+private:
+    // count slots starting at the free-running position as up to two
+    // segments.
+    segments
+    span(const size_type position, const size_type count) noexcept
+    {
+        const auto index = position % MaxSize;
+        const auto first = std::min(count, MaxSize - index);
+        return {std::span<value_type>{m_data.data() + index, first},
+                std::span<value_type>{m_data.data(), count - first}};
+    }
+
+    // Positions run freely; the producer and the consumer each keep a
+    // cached copy of the other side's position on their own cache line and
+    // only reload it when the cached value does not suffice.
+    alignas(detail::cache_line_size) std::atomic<size_type> m_write{};
+    size_type m_read_cache{};
+    alignas(detail::cache_line_size) std::atomic<size_type> m_read{};
+    size_type m_write_cache{};
+    alignas(detail::cache_line_size) std::array<value_type, MaxSize> m_data{};
+};
+
+} // namespace CIRCBUF_ABI_NAMESPACE
+} // namespace circbuf
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace circbuf
+{
+
+// A CircularBuffer policy collecting occupancy counters, e.g. to size
+// buffers from production telemetry:
+//
+//   CircularBuffer<Order, 1024, Statistics> orders;
+//   ...
+//   metrics.gauge("orders.overwrites", orders.policy().overwrites());
+//
+// The clock is a template parameter so that time spent full can be tested
+// deterministically.
+template <typename Clock = std::chrono::steady_clock>
+class BasicStatistics
+{
+public:
+    using clock = Clock;
+    using duration = typename Clock::duration;
+    using time_point = typename Clock::time_point;
+
+    // Number of appended elements, including those overwriting others.
+    std::uint64_t
+    pushes() const noexcept
+    {
+        return m_pushes;
+    }
+
+    // Number of elements removed through pop_front, erase_begin or erase.
+    std::uint64_t
+    pops() const noexcept
+    {
+        return m_pops;
+    }
+
+    // Number of elements lost because they were overwritten by an append to
+    // a full buffer.
+    std::uint64_t
+    overwrites() const noexcept
+    {
+        return m_overwrites;
+    }
+
+    // Largest size the buffer reached.
+    std::size_t
+    high_water_mark() const noexcept
+    {
+        return m_high_water_mark;
+    }
+
+    // Accumulated time the buffer was full, including the current period.
+    duration
+    time_full() const
+    {
+        return m_full ? m_time_full + (Clock::now() - m_full_since)
+                      : m_time_full;
+    }
+
+    // Resets all counters. A currently full buffer starts a new full period.
+    void
+    reset()
+    {
+        m_pushes = 0;
+        m_pops = 0;
+        m_overwrites = 0;
+        m_high_water_mark = 0;
+        m_time_full = duration::zero();
+        if (m_full)
+        {
+            m_full_since = Clock::now();
+        }
+    }
+
+    template <typename Buffer>
+    void
+    on_push(const Buffer& buffer) noexcept
+    {
+        ++m_pushes;
+        m_high_water_mark = std::max(m_high_water_mark, buffer.size());
+        if (!m_full && buffer.full())
+        {
+            m_full = true;
+            m_full_since = Clock::now();
+        }
+    }
+
+    template <typename Buffer>
+    void
+    on_overwrite(const Buffer&) noexcept
+    {
+        ++m_overwrites;
+    }
+
+    template <typename Buffer>
+    void
+    on_pop(const Buffer&) noexcept
+    {
+        ++m_pops;
+        leave_full();
+    }
+
+    template <typename Buffer>
+    void
+    on_clear(const Buffer&) noexcept
+    {
+        leave_full();
+    }
+
+private:
+    void
+    leave_full() noexcept
+    {
+        if (m_full)
+        {
+            m_full = false;
+            m_time_full += Clock::now() - m_full_since;
+        }
+    }
+
+    std::uint64_t m_pushes{};
+    std::uint64_t m_pops{};
+    std::uint64_t m_overwrites{};
+    std::size_t m_high_water_mark{};
+    duration m_time_full{};
+    time_point m_full_since{};
+    bool m_full{};
+};
+
+using Statistics = BasicStatistics<>;
+
+} // namespace circbuf
@@ -0,0 +1,153 @@
+#pragma once
+
+#include "circbuf.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+
+namespace circbuf
+{
+inline namespace CIRCBUF_ABI_NAMESPACE
+{
+namespace detail
+{
+
+// An open addressing table with linear probing that maps keys to the
+// indices under which a container stores its elements. Table is an array
+// or vector of indices whose size is a power of two. The keys live in the
+// container, so the operations that compare or rehash keys take key_of,
+// which returns the key stored under an index. The container keeps the
+// table at most half full, which keeps probe sequences short.
+template <typename Key, typename Table, typename Hash, typename KeyEqual>
+class OpenAddressingTable
+{
+public:
+    using index_type = typename Table::value_type;
+    using size_type = std::size_t;
+
+    // Marks an empty position.
+    static constexpr index_type none = std::numeric_limits<index_type>::max();
+
+    constexpr explicit OpenAddressingTable(Hash hash = Hash{},
+                                           KeyEqual equal = KeyEqual{})
+        : m_hash{std::move(hash)}
+        , m_equal{std::move(equal)}
+    {
+        clear();
+    }
+
+    constexpr size_type
+    size() const noexcept
+    {
+        return m_table.size();
+    }
+
+    constexpr bool
+    empty() const noexcept
+    {
+        return m_table.empty();
+    }
+
+    constexpr index_type&
+    operator[](const size_type position) noexcept
+    {
+        return m_table[position];
+    }
+
+    constexpr index_type
+    operator[](const size_type position) const noexcept
+    {
+        return m_table[position];
+    }
+
+    constexpr void
+    clear() noexcept
+    {
+        std::fill(m_table.begin(), m_table.end(), none);
+    }
+
+    // The position holding key or, if key is not in the table, the empty
+    // position where it would be inserted. The table must not be empty.
+    template <typename KeyOf>
+    constexpr size_type
+    probe(const Key& key, const KeyOf& key_of) const
+    {
+        const auto mask = m_table.size() - 1;
+        auto position = home(key);
+        while (m_table[position] != none &&
+               !m_equal(key_of(m_table[position]), key))
+        {
+            position = (position + 1) & mask;
+        }
+        return position;
+    }
+
+    // Clears a position and closes the gap in its probe sequence by
+    // shifting later entries back, so no tombstones are needed.
+    template <typename KeyOf>
+    constexpr void
+    remove(size_type position, const KeyOf& key_of)
+    {
+        const auto mask = m_table.size() - 1;
+        auto next = position;
+        for (;;)
+        {
+            next = (next + 1) & mask;
+            if (m_table[next] == none)
+            {
+                break;
+            }
+            const auto wanted = home(key_of(m_table[next]));
+            const bool between = position <= next
+                ? position < wanted && wanted <= next
+                : position < wanted || wanted <= next;
+            if (!between)
+            {
+                m_table[position] = m_table[next];
+                position = next;
+            }
+        }
+        m_table[position] = none;
+    }
+
+    // Moves every entry into a new table of size positions.
+    template <typename KeyOf>
+    void
+    rehash(const size_type size, const KeyOf& key_of)
+        requires requires(Table table) { table.resize(size); }
+    {
+        Table table(size, none);
+        std::swap(m_table, table);
+        for (const auto index : table)
+        {
+            if (index != none)
+            {
+                m_table[probe(key_of(index), key_of)] = index;
+            }
+        }
+    }
+
+private:
+    // Fibonacci hashing spreads poor hashes such as the identity of
+    // std::hash<int> over the whole table.
+    constexpr size_type
+    home(const Key& key) const
+    {
+        const auto hash = static_cast<std::uint64_t>(m_hash(key));
+        return static_cast<size_type>(
+            (hash * 0x9E3779B97F4A7C15ull) >>
+            (64 - std::countr_zero(m_table.size())));
+    }
+
+    Table m_table{};
+    CIRCBUF_NO_UNIQUE_ADDRESS Hash m_hash;
+    CIRCBUF_NO_UNIQUE_ADDRESS KeyEqual m_equal;
+};
+
+} // namespace detail
+} // namespace CIRCBUF_ABI_NAMESPACE
+} // namespace circbuf
@@ -0,0 +1,224 @@
+#pragma once
+
+#include "circbuf.h"
+#include "circbuf_compressed.h"
+
+#include <cstddef>
+#include <iterator>
+
+namespace circbuf
+{
+inline namespace CIRCBUF_ABI_NAMESPACE
+{
+
+template <typename BufferType>
+class TieredReverseIterator;
+
+namespace detail
+{
+
+// The policy of the hot tier, which hands every value that falls out of it
+// to the cold tier.
+template <typename Cold>
+struct SpillPolicy
+{
+    constexpr void
+    on_evict(typename Cold::value_type&& value) const noexcept
+    {
+        cold->push_back(value);
+    }
+
+    Cold* cold{};
+};
+
+} // namespace detail
+
+// A two-tier history of numbers. The newest HotSize values are kept raw in
+// a CircularBuffer for cheap access; older values move into a
+// CompressedCircularBuffer of ColdBlocks blocks, which bounds the memory of
+// the long tail:
+//
+//   TieredCircularBuffer<double, 512, 256> prices;
+//   prices.push_back(price);
+//   auto last = prices.hot()[prices.hot().size() - 1];
+//   for (auto it = prices.rbegin(); it != prices.rend(); ++it)
+//   {
+//       // newest first, through both tiers
+//   }
+//
+// The cold tier evicts whole blocks once it is full, so the total number
+// of values varies with how well they compress.
+template <typename T,
+          std::size_t HotSize,
+          std::size_t ColdBlocks,
+          std::size_t BlockBytes = 256,
+          std::size_t BlockValues = 128>
+class TieredCircularBuffer
+{
+public:
+    using cold_type =
+        CompressedCircularBuffer<T, ColdBlocks, BlockBytes, BlockValues>;
+    using hot_type =
+        CircularBuffer<T, HotSize, detail::SpillPolicy<cold_type>>;
+    using value_type = T;
+    using size_type = std::size_t;
+    using const_reverse_iterator =
+        TieredReverseIterator<TieredCircularBuffer>;
+
+    constexpr TieredCircularBuffer() noexcept
+    {
+        m_hot.policy().cold = &m_cold;
+    }
+
+    // The hot tier's policy is pointed at the cold tier of the same buffer.
+    constexpr TieredCircularBuffer(const TieredCircularBuffer& other) noexcept
+        : m_hot{other.m_hot}
+        , m_cold{other.m_cold}
+    {
+        m_hot.policy().cold = &m_cold;
+    }
+
+    constexpr TieredCircularBuffer&
+    operator=(const TieredCircularBuffer& other) noexcept
+    {
+        m_hot = other.m_hot;
+        m_cold = other.m_cold;
+        m_hot.policy().cold = &m_cold;
+        return *this;
+    }
+
+    constexpr size_type
+    size() const noexcept
+    {
+        return m_hot.size() + m_cold.size();
+    }
+
+    constexpr bool
+    empty() const noexcept
+    {
+        return m_hot.empty();
+    }
+
+    constexpr void
+    clear() noexcept
+    {
+        m_hot.clear();
+        m_cold.clear();
+    }
+
+    // The newest values, oldest first.
+    constexpr const hot_type&
+    hot() const noexcept
+    {
+        return m_hot;
+    }
+
+    // The values evicted from the hot tier.
+    constexpr const cold_type&
+    cold() const noexcept
+    {
+        return m_cold;
+    }
+
+    constexpr value_type
+    back() const noexcept(!detail::checked)
+    {
+        return m_hot.back();
+    }
+
+    constexpr void
+    push_back(const value_type value) noexcept
+    {
+        m_hot.push_back(value);
+    }
+
+    constexpr const_reverse_iterator
+    rbegin() const noexcept
+    {
+        return const_reverse_iterator{*this};
+    }
+
+    constexpr std::default_sentinel_t
+    rend() const noexcept
+    {
+        return {};
+    }
+
+private:
+    template <typename BufferType>
+    friend class TieredReverseIterator;
+
+    hot_type m_hot;
+    cold_type m_cold;
+};
+
+// Walks a TieredCircularBuffer from its newest value on, first through the
+// hot tier and then through the cold one.
+template <typename BufferType>
+class TieredReverseIterator
+{
+public:
+    using self_type = TieredReverseIterator;
+    using value_type = typename BufferType::value_type;
+    using difference_type = std::ptrdiff_t;
+    using reference = value_type;
+    using iterator_category = std::input_iterator_tag;
+
+    constexpr TieredReverseIterator() = default;
+
+    explicit constexpr TieredReverseIterator(const BufferType& buffer) noexcept
+        : m_hot{buffer.m_hot.rbegin()}
+        , m_hot_end{buffer.m_hot.rend()}
+        , m_cold{buffer.m_cold.rbegin()}
+    {
+    }
+
+    constexpr value_type
+    operator*() const noexcept(!detail::checked)
+    {
+        return m_hot != m_hot_end ? *m_hot : *m_cold;
+    }
+
+    constexpr self_type&
+    operator++() noexcept
+    {
+        if (m_hot != m_hot_end)
+        {
+            ++m_hot;
+        }
+        else
+        {
+            ++m_cold;
+        }
+        return *this;
+    }
+
+    constexpr self_type
+    operator++(int) noexcept
+    {
+        self_type temp = *this;
+        ++*this;
+        return temp;
+    }
+
+    // Whether the iterator is still in the hot tier.
+    constexpr bool
+    hot() const noexcept
+    {
+        return m_hot != m_hot_end;
+    }
+
+    friend constexpr bool
+    operator==(const self_type& it, std::default_sentinel_t) noexcept
+    {
+        return it.m_hot == it.m_hot_end && it.m_cold == std::default_sentinel;
+    }
+
+private:
+    typename BufferType::hot_type::const_reverse_iterator m_hot;
+    typename BufferType::hot_type::const_reverse_iterator m_hot_end;
+    typename BufferType::cold_type::const_reverse_iterator m_cold;
+};
+
+} // namespace CIRCBUF_ABI_NAMESPACE
+} // namespace circbuf
@@ -0,0 +1,327 @@
+#pragma once
+
+#include "circbuf.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+
+namespace circbuf
+{
+inline namespace CIRCBUF_ABI_NAMESPACE
+{
+
+// Identifies a scheduled timer. It goes stale once the timer fires or is
+// cancelled, so cancelling it afterwards is a no-op.
+struct TimerId
+{
+    std::uint32_t index;
+    std::uint32_t generation;
+
+    friend constexpr bool
+    operator==(const TimerId&, const TimerId&) noexcept = default;
+};
+
+// A hashed hierarchical timing wheel holding up to Capacity timers, each
+// carrying a value of type T. Level 0 is a ring of Slots buckets one tick
+// apart, level 1 a ring of Slots buckets Slots ticks apart and so on:
+//
+//   TimingWheel<OrderId, 256, 4, 65536> timeouts;
+//   auto id = timeouts.schedule(500, order);
+//   timeouts.cancel(*id); // order filled in time
+//   timeouts.advance(1, [](OrderId order) { expire(order); });
+//
+// The wheel keeps its own tick count, starting at 0, and only moves when
+// advance is called, so the caller decides what a tick is and tests can
+// drive it as a simulated clock. Scheduling and cancelling are O(1).
+// Advancing by one tick fires the level 0 bucket of the new tick and, every
+// Slots^L ticks, redistributes the due bucket of level L into the finer
+// levels, which is O(1) amortized per timer. Timers are kept in intrusive
+// lists over a fixed pool, so nothing is allocated after construction.
+template <typename T,
+          std::size_t Slots,
+          std::size_t Levels,
+          std::size_t Capacity>
+    requires(Slots > 1 && Levels > 0 && Capacity > 0 && Capacity < UINT32_MAX)
+class TimingWheel
+{
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using tick_type = std::uint64_t;
+
+    constexpr TimingWheel() noexcept
+    {
+        for (auto& level : m_buckets)
+        {
+            level.fill(none);
+        }
+        for (size_type index = 0; index < Capacity; ++index)
+        {
+            m_nodes[index].next = static_cast<index_type>(index + 1);
+        }
+    }
+
+    consteval static size_type
+    capacity() noexcept
+    {
+        return Capacity;
+    }
+
+    // Delays of at least horizon() ticks are supported but pass through the
+    // coarsest level more than once.
+    consteval static tick_type
+    horizon() noexcept
+    {
+        return span(Levels);
+    }
+
+    constexpr tick_type
+    now() const noexcept
+    {
+        return m_now;
+    }
+
+    constexpr size_type
+    size() const noexcept
+    {
+        return m_size;
+    }
+
+    constexpr bool
+    empty() const noexcept
+    {
+        return m_size == 0;
+    }
+
+    constexpr bool
+    full() const noexcept
+    {
+        return m_size == Capacity;
+    }
+
+    // Schedules value to fire when the wheel reaches now() + delay. A delay
+    // of 0 fires on the next tick. Returns std::nullopt when full.
+    constexpr std::optional<TimerId>
+    schedule(const tick_type delay, value_type value)
+    {
+        if (full())
+        {
+            return std::nullopt;
+        }
+        const auto index = m_free;
+        auto& node = m_nodes[index];
+        node.value.emplace(std::move(value));
+        m_free = node.next;
+        node.when = m_now + (delay == 0 ? 1 : delay);
+        link(index);
+        ++m_size;
+        return TimerId{index, node.generation};
+    }
+
+    // Removes a pending timer without firing it. Returns false if id is
+    // stale.
+    constexpr bool
+    cancel(const TimerId id) noexcept
+    {
+        if (!pending(id))
+        {
+            return false;
+        }
+        unlink(static_cast<index_type>(id.index));
+        release(static_cast<index_type>(id.index));
+        return true;
+    }
+
+    // Whether id refers to a timer that has neither fired nor been
+    // cancelled.
+    constexpr bool
+    pending(const TimerId id) const noexcept
+    {
+        return id.index < Capacity && m_nodes[id.index].value &&
+            m_nodes[id.index].generation == id.generation;
+    }
+
+    // The tick at which a pending timer fires.
+    constexpr tick_type
+    expiry(const TimerId id) const noexcept(!detail::checked)
+    {
+        CIRCBUF_ASSERT(pending(id));
+        return m_nodes[id.index].when;
+    }
+
+    // Moves the wheel forward by ticks, calling fn(value) with every timer
+    // that comes due, in order of expiry. fn may schedule and cancel
+    // timers. Returns the number of timers fired.
+    template <typename Function>
+    constexpr size_type
+    advance(const tick_type ticks, Function&& fn)
+    {
+        size_type fired = 0;
+        for (tick_type tick = 0; tick < ticks; ++tick)
+        {
+            ++m_now;
+            for (size_type level = Levels - 1; level > 0; --level)
+            {
+                if (m_now % span(level) == 0)
+                {
+                    cascade(level);
+                }
+            }
+            auto& head = m_buckets[0][m_now % Slots];
+            while (head != none)
+            {
+                const auto index = head;
+                unlink(index);
+                if (m_nodes[index].when != m_now)
+                {
+                    // clamped into the coarsest level, which is level 0
+                    // if there is only one, and not due yet
+                    link(index);
+                    continue;
+                }
+                auto value = std::move(*m_nodes[index].value);
+                release(index);
+                ++fired;
+                fn(std::move(value));
+            }
+        }
+        return fired;
+    }
+
+    // Moves the wheel forward to tick, which must not be in the past.
+    template <typename Function>
+    constexpr size_type
+    advance_to(const tick_type tick, Function&& fn)
+    {
+        CIRCBUF_ASSERT(tick >= m_now);
+        return advance(tick - m_now, std::forward<Function>(fn));
+    }
+
+    // Cancels all timers.
+    constexpr void
+    clear() noexcept
+    {
+        for (auto& level : m_buckets)
+        {
+            for (auto& head : level)
+            {
+                while (head != none)
+                {
+                    const auto index = head;
+                    unlink(index);
+                    release(index);
+                }
+            }
+        }
+    }
+
+private:
+    using index_type = detail::index_t<Capacity>;
+
+    static constexpr index_type none = static_cast<index_type>(Capacity);
+
+    struct Node
+    {
+        std::optional<value_type> value;
+        tick_type when{};
+        index_type prev{none};
+        index_type next{none};
+        std::uint32_t generation{};
+        std::uint8_t level{};
+        std::uint32_t slot{};
+    };
+
+    // The number of ticks between two buckets of level.
+    static constexpr tick_type
+    span(const size_type level) noexcept
+    {
+        tick_type result = 1;
+        for (size_type i = 0; i < level; ++i)
+        {
+            result *= Slots;
+        }
+        return result;
+    }
+
+    // Puts a timer into the finest level whose ring reaches its expiry. A
+    // bucket of level L is visited at the start of its span, when its
+    // timers are moved into finer levels, so it must not be due again
+    // before the timer expires.
+    constexpr void
+    link(const index_type index) noexcept
+    {
+        auto& node = m_nodes[index];
+        const auto delay = node.when - m_now;
+        size_type level = 0;
+        while (level + 1 < Levels && delay >= span(level + 1))
+        {
+            ++level;
+        }
+        const auto when = delay < span(level + 1)
+            ? node.when
+            : m_now + span(level + 1) - 1;
+        node.level = static_cast<std::uint8_t>(level);
+        node.slot = static_cast<std::uint32_t>(when / span(level) % Slots);
+        auto& head = m_buckets[level][node.slot];
+        node.prev = none;
+        node.next = head;
+        if (head != none)
+        {
+            m_nodes[head].prev = index;
+        }
+        head = index;
+    }
+
+    constexpr void
+    unlink(const index_type index) noexcept
+    {
+        auto& node = m_nodes[index];
+        if (node.prev != none)
+        {
+            m_nodes[node.prev].next = node.next;
+        }
+        else
+        {
+            m_buckets[node.level][node.slot] = node.next;
+        }
+        if (node.next != none)
+        {
+            m_nodes[node.next].prev = node.prev;
+        }
+    }
+
+    constexpr void
+    release(const index_type index) noexcept
+    {
+        auto& node = m_nodes[index];
+        node.value.reset();
+        ++node.generation;
+        node.next = m_free;
+        m_free = index;
+        --m_size;
+    }
+
+    constexpr void
+    cascade(const size_type level) noexcept
+    {
+        auto& head = m_buckets[level][m_now / span(level) % Slots];
+        while (head != none)
+        {
+            const auto index = head;
+            unlink(index);
+            link(index);
+        }
+    }
+
+    std::array<Node, Capacity> m_nodes;
+    std::array<std::array<index_type, Slots>, Levels> m_buckets;
+    index_type m_free{};
+    size_type m_size{};
+    tick_type m_now{};
+};
+
+} // namespace CIRCBUF_ABI_NAMESPACE
+} // namespace circbuf
@@ -0,0 +1,191 @@
+#pragma once
+
+#include "circbuf.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+namespace circbuf
+{
+inline namespace CIRCBUF_ABI_NAMESPACE
+{
+
+// A circular buffer holding the elements of a sliding time window. Each
+// element carries a timestamp obtained through Extractor. Appending an
+// element expires all elements older than the window relative to the new
+// element's timestamp; MaxSize remains a hard cap on the number of
+// elements:
+//
+//   auto timestamp = [](const Trade& trade) { return trade.time; };
+//   TimeWindowBuffer<Trade, 4096, decltype(timestamp)> trades{5s, timestamp};
+//   trades.push_back(trade);      // drops trades older than 5s
+//   trades.expire(clock::now());  // drops trades older than now - 5s
+//
+// Timestamps must be non-decreasing in push order. Expiry locates the
+// first element within the window by binary search and erases the elements
+// before it in one go.
+template <typename T, std::size_t MaxSize, typename Extractor>
+    requires(std::is_invocable_v<const Extractor&, const T&>)
+class TimeWindowBuffer
+{
+public:
+    using buffer_type = CircularBuffer<T, MaxSize>;
+    using value_type = typename buffer_type::value_type;
+    using size_type = typename buffer_type::size_type;
+    using const_reference = typename buffer_type::const_reference;
+    using const_iterator = typename buffer_type::const_iterator;
+    using const_reverse_iterator =
+        typename buffer_type::const_reverse_iterator;
+    using time_point = std::remove_cvref_t<
+        std::invoke_result_t<const Extractor&, const value_type&>>;
+    using duration =
+        decltype(std::declval<time_point>() - std::declval<time_point>());
+
+    // Keeps elements whose timestamp is greater than the latest time minus
+    // window.
+    constexpr explicit TimeWindowBuffer(const duration window,
+                                        Extractor extractor = {})
+        : m_window{window}
+        , m_extractor{std::move(extractor)}
+    {
+    }
+
+    constexpr duration
+    window() const noexcept
+    {
+        return m_window;
+    }
+
+    consteval static size_type
+    max_size() noexcept
+    {
+        return MaxSize;
+    }
+
+    constexpr size_type
+    size() const noexcept
+    {
+        return m_buffer.size();
+    }
+
+    constexpr bool
+    empty() const noexcept
+    {
+        return m_buffer.empty();
+    }
+
+    constexpr bool
+    full() const noexcept
+    {
+        return m_buffer.full();
+    }
+
+    constexpr void
+    clear() noexcept(noexcept(m_buffer.clear()))
+    {
+        m_buffer.clear();
+    }
+
+    constexpr const_reference
+    operator[](const size_type index) const noexcept(!detail::checked)
+    {
+        return m_buffer[index];
+    }
+
+    constexpr const_reference
+    front() const noexcept(!detail::checked)
+    {
+        return m_buffer.front();
+    }
+
+    constexpr const_reference
+    back() const noexcept(!detail::checked)
+    {
+        return m_buffer.back();
+    }
+
+    constexpr const buffer_type&
+    buffer() const noexcept
+    {
+        return m_buffer;
+    }
+
+    constexpr void
+    push_back(const value_type& value)
+    {
+        expire(timestamp(value));
+        m_buffer.push_back(value);
+    }
+
+    constexpr void
+    push_back(value_type&& value)
+    {
+        expire(timestamp(value));
+        m_buffer.push_back(std::move(value));
+    }
+
+    constexpr value_type
+    pop_front()
+    {
+        return m_buffer.pop_front();
+    }
+
+    // Removes all elements whose timestamp is at or before now - window()
+    // and returns how many were removed.
+    constexpr size_type
+    expire(const time_point now)
+    {
+        const auto cutoff = now - m_window;
+        const auto first = std::partition_point(
+            m_buffer.cbegin(),
+            m_buffer.cend(),
+            [this, &cutoff](const value_type& value) {
+                return !(cutoff < timestamp(value));
+            });
+        const auto count =
+            static_cast<size_type>(std::distance(m_buffer.cbegin(), first));
+        m_buffer.erase_begin(count);
+        return count;
+    }
+
+    constexpr const_iterator
+    begin() const noexcept
+    {
+        return m_buffer.begin();
+    }
+
+    constexpr const_iterator
+    end() const noexcept
+    {
+        return m_buffer.end();
+    }
+
+    constexpr const_reverse_iterator
+    rbegin() const noexcept
+    {
+        return m_buffer.rbegin();
+    }
+
+    constexpr const_reverse_iterator
+    rend() const noexcept
+    {
+        return m_buffer.rend();
+    }
+
+private:
+    constexpr time_point
+    timestamp(const value_type& value) const
+    {
+        return std::invoke(m_extractor, value);
+    }
+
+    buffer_type m_buffer;
+    duration m_window;
+    Extractor m_extractor;
+};
+
+} // namespace CIRCBUF_ABI_NAMESPACE
+} // namespace circbuf
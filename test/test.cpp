@@ -2,6 +2,15 @@
 #include "catch_amalgamated.hpp"
 #include "circbuf.h"
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+
 #ifndef __APPLE__ // no ranges support on Apple platform
 #include <ranges>
 #endif
@@ -33,6 +42,19 @@ static_assert(
                      iterator_category>::value,
     "const reverse iterator is random access");
 
+// Checked mode adds a 32-bit generation counter to the bookkeeping.
+static_assert(sizeof(circbuf::CircularBuffer<char, 16>) ==
+                  (circbuf::detail::checked ? 24 : 18),
+              "bookkeeping of small buffers uses narrow indices");
+
+static_assert(sizeof(circbuf::CircularBuffer<int, 1000>) ==
+                  sizeof(std::array<int, 1000>) + 2 * sizeof(std::uint16_t) +
+                      (circbuf::detail::checked ? sizeof(std::uint32_t) : 0),
+              "bookkeeping of medium buffers uses narrow indices");
+
+static_assert(std::is_empty_v<circbuf::detail::Generation<false>>,
+              "unchecked buffers carry no generation counter");
+
 #ifndef __APPLE__ // no ranges support on Apple platform
 static_assert(std::ranges::random_access_range<circbuf::CircularBuffer<int, 3>>,
               "buffer is random access range");
@@ -190,6 +212,283 @@ TEST_CASE("test_with_capacity_of_one")
     REQUIRE(cb.empty());
 }
 
+TEST_CASE("test_push_after_drain")
+{
+    using Buf = circbuf::CircularBuffer<int, 3>;
+    Buf cb;
+    for (int round = 0; round < 4; ++round)
+    {
+        cb.push_back(round);
+        cb.push_back(round + 1);
+        REQUIRE(round == cb.front());
+        REQUIRE(round + 1 == cb.back());
+        REQUIRE(round == cb.pop_front());
+        REQUIRE(round + 1 == cb.pop_front());
+        REQUIRE(cb.empty());
+    }
+    cb.push_back(42);
+    REQUIRE(42 == cb.front());
+    REQUIRE(42 == cb.back());
+    REQUIRE(42 == *cb.begin());
+}
+
+TEST_CASE("test_erase_begin")
+{
+    using Buf = circbuf::CircularBuffer<std::string, 4>;
+    Buf cb;
+    for (int i = 0; i < 6; ++i)
+    {
+        cb.push_back(std::to_string(i));
+    }
+    cb.erase_begin(0);
+    REQUIRE(4 == cb.size());
+    cb.erase_begin(3);
+    REQUIRE(1 == cb.size());
+    REQUIRE("5" == cb.front());
+    cb.push_back("6");
+    REQUIRE(std::vector<std::string>{"5", "6"} ==
+            std::vector<std::string>(cb.begin(), cb.end()));
+    cb.erase_begin(2);
+    REQUIRE(cb.empty());
+}
+
+TEST_CASE("test_linearize")
+{
+    using Buf = circbuf::CircularBuffer<double, 5>;
+    Buf cb;
+    cb.push_back(1);
+    cb.push_back(2);
+    REQUIRE(cb.is_linearized());
+    REQUIRE(std::vector<double>{1, 2} ==
+            std::vector<double>(cb.linearize().begin(), cb.linearize().end()));
+    for (int i = 3; i <= 8; ++i)
+    {
+        cb.push_back(i);
+    }
+    cb.pop_front();
+    REQUIRE(!cb.is_linearized());
+    const auto span = cb.linearize();
+    REQUIRE(cb.is_linearized());
+    REQUIRE(std::vector<double>{5, 6, 7, 8} ==
+            std::vector<double>(span.begin(), span.end()));
+    REQUIRE(&cb.front() == span.data());
+    cb.push_back(9);
+    cb.push_back(10);
+    REQUIRE(std::vector<double>{6, 7, 8, 9, 10} ==
+            std::vector<double>(cb.begin(), cb.end()));
+}
+
+TEST_CASE("test_copy_linear")
+{
+    circbuf::CircularBuffer<int, 4> cb;
+    std::vector<int> out(6, -1);
+    REQUIRE(0 == cb.copy_linear(out));
+    for (int i = 0; i < 6; ++i)
+    {
+        cb.push_back(i);
+    }
+    REQUIRE(4 == cb.copy_linear(out));
+    REQUIRE(std::vector<int>{2, 3, 4, 5, -1, -1} == out);
+
+    circbuf::CircularBuffer<std::string, 2> strings;
+    strings.push_back("a");
+    strings.push_back("b");
+    strings.push_back("c");
+    std::vector<std::string> copy(2);
+    REQUIRE(2 == strings.copy_linear(copy));
+    REQUIRE(std::vector<std::string>{"b", "c"} == copy);
+}
+
+TEST_CASE("test_insert")
+{
+    circbuf::CircularBuffer<std::string, 5> cb;
+    cb.push_back("a");
+    cb.push_back("c");
+    auto it = cb.insert(cb.begin() + 1, "b");
+    REQUIRE("b" == *it);
+    it = cb.insert(cb.begin(), std::string{"0"});
+    REQUIRE("0" == *it);
+    it = cb.insert(cb.end(), "d");
+    REQUIRE("d" == *it);
+    REQUIRE(std::vector<std::string>{"0", "a", "b", "c", "d"} ==
+            std::vector<std::string>(cb.begin(), cb.end()));
+    // a full buffer overwrites its front element first
+    it = cb.insert(cb.begin() + 2, "x");
+    REQUIRE("x" == *it);
+    REQUIRE(std::vector<std::string>{"a", "x", "b", "c", "d"} ==
+            std::vector<std::string>(cb.begin(), cb.end()));
+    // inserting before the front of a full buffer inserts nothing
+    it = cb.insert(cb.begin(), "y");
+    REQUIRE(it == cb.end());
+    REQUIRE(std::vector<std::string>{"a", "x", "b", "c", "d"} ==
+            std::vector<std::string>(cb.begin(), cb.end()));
+}
+
+TEST_CASE("test_erase")
+{
+    circbuf::CircularBuffer<std::string, 6> cb;
+    for (int i = 0; i < 9; ++i)
+    {
+        cb.push_back(std::to_string(i));
+    }
+    auto it = cb.erase(cb.begin() + 1);
+    REQUIRE("5" == *it);
+    it = cb.erase(cb.begin() + 3);
+    REQUIRE("8" == *it);
+    REQUIRE(std::vector<std::string>{"3", "5", "6", "8"} ==
+            std::vector<std::string>(cb.begin(), cb.end()));
+    it = cb.erase(cb.begin() + 1, cb.begin() + 3);
+    REQUIRE("8" == *it);
+    REQUIRE(std::vector<std::string>{"3", "8"} ==
+            std::vector<std::string>(cb.begin(), cb.end()));
+    it = cb.erase(cb.begin(), cb.end());
+    REQUIRE(it == cb.end());
+    REQUIRE(cb.empty());
+}
+
+TEST_CASE("test_insert_erase_against_deque")
+{
+    circbuf::CircularBuffer<int, 16> cb;
+    std::deque<int> exp;
+    std::mt19937 engine{7};
+    for (int i = 0; i < 5000; ++i)
+    {
+        const auto size = static_cast<int>(cb.size());
+        const auto index = std::uniform_int_distribution<int>{0, size}(engine);
+        switch (std::uniform_int_distribution<int>{0, 3}(engine))
+        {
+        case 0:
+        case 1:
+            if (cb.full())
+            {
+                if (index == 0)
+                {
+                    break;
+                }
+                exp.pop_front();
+                cb.insert(cb.begin() + index, i);
+                exp.insert(exp.begin() + index - 1, i);
+            }
+            else
+            {
+                cb.insert(cb.begin() + index, i);
+                exp.insert(exp.begin() + index, i);
+            }
+            break;
+        case 2:
+            if (index < size)
+            {
+                cb.erase(cb.begin() + index);
+                exp.erase(exp.begin() + index);
+            }
+            break;
+        default:
+        {
+            const auto count =
+                std::uniform_int_distribution<int>{0, size - index}(engine);
+            cb.erase(cb.begin() + index, cb.begin() + index + count);
+            exp.erase(exp.begin() + index, exp.begin() + index + count);
+            break;
+        }
+        }
+        REQUIRE(std::equal(cb.begin(), cb.end(), exp.begin(), exp.end()));
+    }
+}
+
+namespace
+{
+
+struct ByteSink
+{
+    void
+    operator()(const std::span<const std::byte> bytes)
+    {
+        data.insert(data.end(), bytes.begin(), bytes.end());
+        ++writes;
+    }
+
+    std::vector<std::byte> data;
+    int writes{};
+};
+
+struct ByteSource
+{
+    bool
+    operator()(const std::span<std::byte> bytes)
+    {
+        if (data.size() - position < bytes.size())
+        {
+            return false;
+        }
+        std::copy_n(data.begin() + static_cast<std::ptrdiff_t>(position),
+                    bytes.size(),
+                    bytes.begin());
+        position += bytes.size();
+        return true;
+    }
+
+    const std::vector<std::byte>& data;
+    std::size_t position{};
+};
+
+} // namespace
+
+TEST_CASE("test_serialize_roundtrip")
+{
+    circbuf::CircularBuffer<std::uint64_t, 5> cb;
+    for (std::uint64_t i = 0; i < 8; ++i)
+    {
+        cb.push_back(i);
+    }
+    ByteSink sink;
+    cb.serialize(sink);
+    // header and two segments since the elements wrap around
+    REQUIRE(3 == sink.writes);
+    REQUIRE(sizeof(circbuf::SnapshotHeader) + 5 * sizeof(std::uint64_t) ==
+            sink.data.size());
+
+    circbuf::CircularBuffer<std::uint64_t, 8> restored;
+    restored.push_back(42);
+    REQUIRE(restored.deserialize(ByteSource{sink.data}));
+    REQUIRE(std::vector<std::uint64_t>{3, 4, 5, 6, 7} ==
+            std::vector<std::uint64_t>(restored.begin(), restored.end()));
+    restored.push_back(8);
+    REQUIRE(8 == restored.back());
+
+    circbuf::CircularBuffer<std::uint64_t, 5> empty;
+    ByteSink empty_sink;
+    empty.serialize(empty_sink);
+    REQUIRE(restored.deserialize(ByteSource{empty_sink.data}));
+    REQUIRE(restored.empty());
+}
+
+TEST_CASE("test_deserialize_rejects_mismatch")
+{
+    circbuf::CircularBuffer<std::uint32_t, 4> cb;
+    cb.push_back(1);
+    cb.push_back(2);
+    cb.push_back(3);
+    ByteSink sink;
+    cb.serialize(sink);
+
+    circbuf::CircularBuffer<std::uint64_t, 4> wider;
+    REQUIRE(!wider.deserialize(ByteSource{sink.data}));
+    circbuf::CircularBuffer<std::uint32_t, 2> smaller;
+    smaller.push_back(7);
+    REQUIRE(!smaller.deserialize(ByteSource{sink.data}));
+    REQUIRE(smaller.empty());
+
+    auto truncated = sink.data;
+    truncated.pop_back();
+    circbuf::CircularBuffer<std::uint32_t, 4> restored;
+    REQUIRE(!restored.deserialize(ByteSource{truncated}));
+    REQUIRE(restored.empty());
+
+    auto newer = sink.data;
+    newer[0] = std::byte{0xff};
+    REQUIRE(!restored.deserialize(ByteSource{newer}));
+}
+
 TEST_CASE("test_object_creation")
 {
     using Buf = circbuf::CircularBuffer<int, 2>;
@@ -420,6 +719,85 @@ TEST_CASE("test_reverse_iterator_decrement")
     REQUIRE(43 == *it4);
 }
 
+TEST_CASE("test_iterator_wraps_around_storage")
+{
+    using Buf = circbuf::CircularBuffer<int, 4>;
+    Buf cb;
+    for (int i = 0; i < 7; ++i)
+    {
+        cb.push_back(i);
+    }
+    const std::vector<int> exp{3, 4, 5, 6};
+    REQUIRE(exp == std::vector<int>(cb.begin(), cb.end()));
+    REQUIRE(exp == std::vector<int>(cb.cbegin(), cb.cend()));
+    const std::vector<int> rexp{6, 5, 4, 3};
+    REQUIRE(rexp == std::vector<int>(cb.rbegin(), cb.rend()));
+    REQUIRE(rexp == std::vector<int>(cb.crbegin(), cb.crend()));
+    auto it = cb.end();
+    auto rit = cb.rend();
+    for (auto value = 6; value >= 3; --value)
+    {
+        REQUIRE(value == *--it);
+        REQUIRE(9 - value == *--rit);
+    }
+}
+
+TEST_CASE("test_iterator_wraps_around_storage_with_move_only")
+{
+    using Buf = circbuf::CircularBuffer<std::unique_ptr<int>, 3>;
+    Buf cb;
+    for (int i = 0; i < 5; ++i)
+    {
+        cb.push_back(std::make_unique<int>(i));
+    }
+    std::vector<int> values;
+    for (const auto& value : cb)
+    {
+        values.push_back(*value);
+    }
+    const std::vector<int> exp{2, 3, 4};
+    REQUIRE(exp == values);
+    std::vector<int> rvalues;
+    for (auto it = cb.rbegin(); it != cb.rend(); ++it)
+    {
+        rvalues.push_back(**it);
+    }
+    const std::vector<int> rexp{4, 3, 2};
+    REQUIRE(rexp == rvalues);
+}
+
+TEST_CASE("test_reverse_iterator_after_pushes_to_partial_buffer")
+{
+    using Buf = circbuf::CircularBuffer<int, 5>;
+    Buf cb;
+    for (int i = 0; i < 7; ++i)
+    {
+        cb.push_back(i);
+    }
+    cb.pop_front();
+    cb.pop_front();
+    // The elements now start at the last slot, so the next pushes fill a
+    // buffer that is not full while the storage wraps around.
+    for (int i = 7; i < 10; ++i)
+    {
+        cb.push_back(i);
+        std::vector<int> rexp(cb.begin(), cb.end());
+        std::reverse(rexp.begin(), rexp.end());
+        REQUIRE(rexp == std::vector<int>(cb.rbegin(), cb.rend()));
+        REQUIRE(rexp == std::vector<int>(cb.crbegin(), cb.crend()));
+        REQUIRE(i == *cb.rbegin());
+        REQUIRE(i == cb.rbegin()[0]);
+        REQUIRE(rexp.back() == *(cb.rend() - 1));
+        for (std::size_t k = 0; k < rexp.size(); ++k)
+        {
+            REQUIRE(rexp[k] == cb.rbegin()[static_cast<std::ptrdiff_t>(k)]);
+        }
+    }
+    REQUIRE(cb.full());
+    REQUIRE(std::vector<int>{9, 8, 7, 6, 5} ==
+            std::vector<int>(cb.rbegin(), cb.rend()));
+}
+
 TEST_CASE("test_iterator_comparison")
 {
     using Buf = circbuf::CircularBuffer<int, 5>;
@@ -466,6 +844,36 @@ TEST_CASE("test_reverse_iterator_comparison")
     REQUIRE(it2 > it);
 }
 
+TEST_CASE("test_iterator_arithmetic_on_full_buffer")
+{
+    circbuf::CircularBuffer<int, 5> cb;
+    for (int i = 0; i < 7; ++i)
+    {
+        cb.push_back(i);
+    }
+    REQUIRE(cb.begin() + 5 == cb.end());
+    REQUIRE(5 + cb.begin() == cb.end());
+    REQUIRE(cb.end() - 5 == cb.begin());
+    REQUIRE(cb.rbegin() + 5 == cb.rend());
+    REQUIRE(6 == *(cb.end() - 1));
+    REQUIRE(2 == *(cb.rend() - 1));
+    auto it = cb.end();
+    it -= 3;
+    REQUIRE(4 == *it);
+    it += 3;
+    REQUIRE(it == cb.end());
+    REQUIRE(5 == std::distance(cb.begin(), cb.end()));
+    for (int value = 2; value <= 6; ++value)
+    {
+        REQUIRE(value - 2 == std::lower_bound(cb.begin(), cb.end(), value) -
+                    cb.begin());
+    }
+    REQUIRE(cb.end() == std::lower_bound(cb.begin(), cb.end(), 7));
+    std::sort(cb.begin(), cb.end(), std::greater<>{});
+    REQUIRE(std::vector<int>{6, 5, 4, 3, 2} ==
+            std::vector<int>(cb.begin(), cb.end()));
+}
+
 TEST_CASE("test_global_begin_end")
 {
     using Buf = circbuf::CircularBuffer<int, 5>;
@@ -514,6 +922,84 @@ TEST_CASE("test_for_loop")
     REQUIRE(exp == values);
 }
 
+namespace
+{
+
+struct Spill
+{
+    void
+    on_evict(std::string&& value)
+    {
+        evicted.push_back(std::move(value));
+    }
+
+    std::vector<std::string> evicted;
+};
+
+struct SpillRuns
+{
+    void
+    on_evict_range(std::span<int> run)
+    {
+        runs.emplace_back(run.begin(), run.end());
+    }
+
+    std::vector<std::vector<int>> runs;
+};
+
+} // namespace
+
+TEST_CASE("test_evict_policy")
+{
+    circbuf::CircularBuffer<std::string, 2, Spill> cb;
+    cb.push_back("a");
+    cb.push_back("b");
+    REQUIRE(cb.policy().evicted.empty());
+    cb.push_back("c");
+    cb.emplace_back("d");
+    const std::vector<std::string> exp{"a", "b"};
+    REQUIRE(exp == cb.policy().evicted);
+    REQUIRE("c" == cb.front());
+    REQUIRE("d" == cb.back());
+    const std::vector<std::string> values{"e", "f", "g"};
+    cb.append(values.begin(), values.end());
+    const std::vector<std::string> exp2{"a", "b", "c", "d", "e"};
+    REQUIRE(exp2 == cb.policy().evicted);
+    REQUIRE("f" == cb.front());
+    REQUIRE("g" == cb.back());
+}
+
+TEST_CASE("test_evict_range_policy")
+{
+    circbuf::CircularBuffer<int, 4, SpillRuns> cb;
+    cb.push_back(1);
+    cb.push_back(2);
+    cb.push_back(3);
+    const std::vector<int> values{4, 5, 6, 7, 8, 9, 10, 11, 12};
+    cb.append(values.begin(), values.end());
+    // runs are split where they wrap around the storage
+    const std::vector<std::vector<int>> exp{{1, 2, 3, 4}, {5, 6, 7, 8}};
+    REQUIRE(exp == cb.policy().runs);
+    const std::vector<int> rest{9, 10, 11, 12};
+    REQUIRE(rest == std::vector<int>(cb.begin(), cb.end()));
+    cb.push_back(13);
+    REQUIRE(std::vector<int>{9} == cb.policy().runs.back());
+    const std::vector<int> more{14, 15};
+    cb.append(more.begin(), more.end());
+    REQUIRE(std::vector<int>{10, 11} == cb.policy().runs.back());
+}
+
+TEST_CASE("test_append")
+{
+    circbuf::CircularBuffer<int, 3> cb;
+    const std::vector<int> values{1, 2, 3, 4, 5};
+    cb.append(values.begin(), values.begin() + 2);
+    REQUIRE(std::vector<int>{1, 2} == std::vector<int>(cb.begin(), cb.end()));
+    cb.append(values.begin() + 2, values.end());
+    REQUIRE(std::vector<int>{3, 4, 5} ==
+            std::vector<int>(cb.begin(), cb.end()));
+}
+
 TEST_CASE("test_with_move_only")
 {
     using Buf = circbuf::CircularBuffer<MoveOnly, 3>;
@@ -546,6 +1032,86 @@ TEST_CASE("test_cleanup")
     cb.push_back(MoveOnly{});
 }
 
+namespace
+{
+
+// Counts its live instances.
+struct Counted
+{
+    Counted() noexcept
+    {
+        ++live;
+    }
+
+    Counted(const Counted&) noexcept
+    {
+        ++live;
+    }
+
+    Counted(Counted&&) noexcept
+    {
+        ++live;
+    }
+
+    Counted&
+    operator=(const Counted&) = default;
+
+    Counted&
+    operator=(Counted&&) = default;
+
+    ~Counted()
+    {
+        --live;
+    }
+
+    inline static int live{};
+};
+
+} // namespace
+
+TEST_CASE("test_pop_front_destroys_element")
+{
+    circbuf::CircularBuffer<Counted, 4> cb;
+    cb.push_back(Counted{});
+    cb.push_back(Counted{});
+    cb.push_back(Counted{});
+    REQUIRE(Counted::live == 3);
+    cb.pop_front();
+    REQUIRE(Counted::live == 2);
+    {
+        const auto popped = cb.pop_front();
+        REQUIRE(Counted::live == 2);
+    }
+    REQUIRE(Counted::live == 1);
+    cb.clear();
+    REQUIRE(Counted::live == 0);
+}
+
+TEST_CASE("test_clear_destroys_live_elements")
+{
+    using Buf = circbuf::CircularBuffer<std::string, 4>;
+    const std::string value(64, 'x');
+    Buf cb;
+    for (int i = 0; i < 6; ++i)
+    {
+        cb.push_back(value);
+    }
+    cb.pop_front();
+    cb.clear();
+    REQUIRE(cb.empty());
+    cb.push_back(value);
+    cb.push_back(value);
+    REQUIRE(cb.front() == value);
+
+    Buf moved{std::move(cb)};
+    REQUIRE(cb.empty());
+    REQUIRE(moved.size() == 2);
+    cb = moved;
+    cb.clear();
+    cb = std::move(moved);
+    REQUIRE(cb.size() == 2);
+}
+
 TEST_CASE("test_const_iterator_methods")
 {
     using Buf = circbuf::CircularBuffer<CopyOnly, 3>;
@@ -682,6 +1248,19 @@ consteval_max_size()
 
 static_assert(3 == consteval_max_size());
 
+consteval auto
+consteval_linearize()
+{
+    circbuf::CircularBuffer<int, 3> buf;
+    buf.push_back(43);
+    buf.push_back(44);
+    buf.push_back(45);
+    buf.push_back(46);
+    return buf.linearize()[0];
+}
+
+static_assert(44 == consteval_linearize());
+
 consteval auto
 consteval_size()
 {
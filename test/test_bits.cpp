@@ -0,0 +1,147 @@
+#include "catch_amalgamated.hpp"
+#include "circbuf_bits.h"
+
+#include <deque>
+#include <random>
+
+namespace
+{
+
+consteval auto
+consteval_bits_count()
+{
+    circbuf::BitCircularBuffer<5> buf;
+    buf.push_back(true);
+    buf.push_back(false);
+    buf.push_back_word(0b1111, 4);
+    return buf.count();
+}
+
+static_assert(4 == consteval_bits_count());
+
+static_assert(sizeof(circbuf::BitCircularBuffer<1024>) ==
+                  1024 / 8 + sizeof(std::uint64_t),
+              "flags are packed");
+
+template <std::size_t MaxSize, std::size_t Bits>
+void
+check_against_deque(const unsigned seed)
+{
+    using Buf = circbuf::BitCircularBuffer<MaxSize, Bits>;
+    using Value = typename Buf::value_type;
+    Buf buf;
+    std::deque<Value> exp;
+    std::mt19937 engine{seed};
+    const auto push = [&](const Value value) {
+        exp.push_back(value);
+        if (exp.size() > MaxSize)
+        {
+            exp.pop_front();
+        }
+    };
+    for (int step = 0; step < 2000; ++step)
+    {
+        const auto action = engine() % 8;
+        if (action < 4)
+        {
+            const auto value =
+                static_cast<Value>(engine() & ((1ull << Bits) - 1));
+            buf.push_back(value);
+            push(value);
+        }
+        else if (action < 6)
+        {
+            const auto count = engine() % (Buf::values_per_word + 1);
+            const std::uint64_t word =
+                (std::uint64_t{engine()} << 32) | engine();
+            buf.push_back_word(word, count);
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                push(static_cast<Value>((word >> (i * Bits)) &
+                                        ((1ull << Bits) - 1)));
+            }
+        }
+        else if (!exp.empty())
+        {
+            REQUIRE(exp.front() == buf.pop_front());
+            exp.pop_front();
+        }
+        REQUIRE(exp.size() == buf.size());
+        for (std::size_t i = 0; i < exp.size(); ++i)
+        {
+            REQUIRE(exp[i] == buf[i]);
+        }
+        const auto value = static_cast<Value>(engine() & ((1ull << Bits) - 1));
+        const auto last = exp.empty() ? 0 : engine() % (exp.size() + 1);
+        REQUIRE(static_cast<std::size_t>(
+                    std::count(exp.end() - static_cast<long>(last),
+                               exp.end(),
+                               value)) == buf.count_last(last, value));
+        REQUIRE(static_cast<std::size_t>(
+                    std::count(exp.begin(), exp.end(), value)) ==
+                buf.count(value));
+    }
+}
+
+} // namespace
+
+TEST_CASE("test_bits_roundtrip")
+{
+    circbuf::BitCircularBuffer<3> buf;
+    REQUIRE(buf.empty());
+    buf.push_back(true);
+    buf.push_back(false);
+    buf.push_back(true);
+    REQUIRE(buf.full());
+    REQUIRE(2 == buf.count());
+    buf.push_back(false);
+    REQUIRE(!buf.front());
+    REQUIRE(!buf.back());
+    REQUIRE(1 == buf.count());
+    REQUIRE(1 == buf.count_last(2));
+    buf.set(0, true);
+    REQUIRE(buf[0]);
+    REQUIRE(buf.pop_front());
+    REQUIRE(2 == buf.size());
+    buf.clear();
+    REQUIRE(buf.empty());
+    REQUIRE(0 == buf.count());
+}
+
+TEST_CASE("test_bits_count_last_beyond_size")
+{
+    circbuf::BitCircularBuffer<4096> acks;
+    for (int i = 0; i < 10; ++i)
+    {
+        acks.push_back(i % 3 == 0);
+    }
+    REQUIRE(4 == acks.count_last(1000));
+    REQUIRE(6 == acks.count_last(1000, false));
+    REQUIRE(0 == circbuf::BitCircularBuffer<8>{}.count_last(5));
+}
+
+TEST_CASE("test_bits_small_integers")
+{
+    circbuf::BitCircularBuffer<10, 4> buf;
+    buf.push_back_word(0x4321, 4);
+    REQUIRE(4 == buf.size());
+    REQUIRE(1 == buf[0]);
+    REQUIRE(4 == buf[3]);
+    buf.push_back(15);
+    REQUIRE(15 == buf.back());
+    REQUIRE(1 == buf.count(3));
+    REQUIRE(0 == buf.count(7));
+}
+
+TEST_CASE("test_bits_against_deque")
+{
+    check_against_deque<1, 1>(1);
+    check_against_deque<7, 1>(2);
+    check_against_deque<64, 1>(3);
+    check_against_deque<130, 1>(4);
+    check_against_deque<50, 2>(5);
+    check_against_deque<33, 4>(6);
+    check_against_deque<20, 8>(7);
+    check_against_deque<9, 16>(8);
+    check_against_deque<5, 32>(9);
+}
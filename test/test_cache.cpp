@@ -0,0 +1,303 @@
+#include "catch_amalgamated.hpp"
+#include "circbuf_cache.h"
+
+#include <cstddef>
+#include <list>
+#include <map>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+namespace
+{
+
+// A reference LRU cache to compare hit rates with.
+class LruCache
+{
+public:
+    explicit LruCache(const std::size_t capacity)
+        : m_capacity{capacity}
+    {
+    }
+
+    bool
+    access(const int key)
+    {
+        const auto found = m_index.find(key);
+        if (found != m_index.end())
+        {
+            m_order.splice(m_order.begin(), m_order, found->second);
+            return true;
+        }
+        if (m_order.size() == m_capacity)
+        {
+            m_index.erase(m_order.back());
+            m_order.pop_back();
+        }
+        m_order.push_front(key);
+        m_index.emplace(key, m_order.begin());
+        return false;
+    }
+
+private:
+    std::size_t m_capacity;
+    std::list<int> m_order;
+    std::unordered_map<int, std::list<int>::iterator> m_index;
+};
+
+// Sends every key to the same table position, so lookups and removals
+// have to walk and repair one long probe sequence.
+struct ConstantHash
+{
+    std::size_t
+    operator()(int) const noexcept
+    {
+        return 0;
+    }
+};
+
+} // namespace
+
+TEST_CASE("test_cache_put_and_find")
+{
+    circbuf::ClockCache<int, std::string, 3> cache;
+    REQUIRE(cache.empty());
+    REQUIRE(cache.find(1) == nullptr);
+    REQUIRE(cache.put(1, "one") == "one");
+    cache.put(2, "two");
+    REQUIRE(cache.size() == 2);
+    REQUIRE(*cache.find(1) == "one");
+    cache.put(1, "uno");
+    REQUIRE(*cache.find(1) == "uno");
+    REQUIRE(cache.size() == 2);
+    *cache.find(2) = "dos";
+    REQUIRE(*cache.find(2) == "dos");
+    REQUIRE(cache.contains(2));
+    REQUIRE(!cache.contains(3));
+}
+
+TEST_CASE("test_cache_second_chance")
+{
+    circbuf::ClockCache<int, int, 3> cache;
+    cache.put(1, 10);
+    cache.put(2, 20);
+    cache.put(3, 30);
+    REQUIRE(cache.full());
+
+    // 1 was used since it was cached, so the hand spares it once.
+    cache.find(1);
+    cache.put(4, 40);
+    REQUIRE(cache.contains(1));
+    REQUIRE(!cache.contains(2));
+    REQUIRE(cache.contains(3));
+    REQUIRE(cache.contains(4));
+
+    // The hand continues after 2; 3 has not been used.
+    cache.put(5, 50);
+    REQUIRE(!cache.contains(3));
+
+    // All bits are clear again, so the hand wraps around to 1.
+    cache.put(6, 60);
+    REQUIRE(!cache.contains(1));
+    REQUIRE(cache.size() == 3);
+}
+
+TEST_CASE("test_cache_erase_and_clear")
+{
+    circbuf::ClockCache<int, int, 4> cache;
+    for (int key = 0; key < 4; ++key)
+    {
+        cache.put(key, key);
+    }
+    REQUIRE(cache.erase(2));
+    REQUIRE(!cache.erase(2));
+    REQUIRE(cache.size() == 3);
+    cache.put(7, 7);
+    REQUIRE(cache.size() == 4);
+    REQUIRE(cache.contains(0));
+    REQUIRE(cache.contains(7));
+
+    std::map<int, int> seen;
+    cache.for_each([&](const int key, const int value) { seen[key] = value; });
+    REQUIRE(seen == std::map<int, int>{{0, 0}, {1, 1}, {3, 3}, {7, 7}});
+
+    cache.clear();
+    REQUIRE(cache.empty());
+    REQUIRE(!cache.contains(0));
+    cache.put(5, 5);
+    REQUIRE(*cache.find(5) == 5);
+}
+
+TEST_CASE("test_cache_colliding_keys")
+{
+    circbuf::ClockCache<int, int, 8, ConstantHash> cache;
+    for (int key = 0; key < 8; ++key)
+    {
+        cache.put(key, key * 10);
+    }
+    for (int key = 0; key < 8; key += 2)
+    {
+        REQUIRE(cache.erase(key));
+    }
+    for (int key = 1; key < 8; key += 2)
+    {
+        REQUIRE(*cache.find(key) == key * 10);
+    }
+    for (int key = 0; key < 8; key += 2)
+    {
+        REQUIRE(!cache.contains(key));
+    }
+}
+
+TEST_CASE("test_cache_move_only_values")
+{
+    circbuf::ClockCache<int, std::unique_ptr<int>, 2> cache;
+    cache.put(1, std::make_unique<int>(1));
+    cache.put(2, std::make_unique<int>(2));
+    cache.put(3, std::make_unique<int>(3));
+    REQUIRE(cache.size() == 2);
+    REQUIRE(**cache.find(3) == 3);
+}
+
+TEST_CASE("test_cache_put_keeps_slot_on_throw")
+{
+    struct Fragile
+    {
+        explicit Fragile(const bool fail)
+            : fail{fail}
+        {
+        }
+
+        Fragile(Fragile&& other)
+            : fail{other.fail}
+        {
+            if (fail)
+            {
+                throw std::runtime_error{"move"};
+            }
+        }
+
+        Fragile&
+        operator=(Fragile&&) = default;
+
+        bool fail;
+    };
+
+    circbuf::ClockCache<int, Fragile, 2> cache;
+    REQUIRE_THROWS_AS(cache.put(1, Fragile{true}), std::runtime_error);
+    REQUIRE(cache.empty());
+    REQUIRE(!cache.contains(1));
+    cache.put(2, Fragile{false});
+    cache.put(3, Fragile{false});
+    REQUIRE(cache.full());
+    REQUIRE(cache.find(2));
+    REQUIRE(cache.find(3));
+}
+
+TEST_CASE("test_cache_against_map")
+{
+    circbuf::ClockCache<int, int, 64> cache;
+    std::map<int, int> values;
+    std::mt19937 engine{3};
+    for (int i = 0; i < 20000; ++i)
+    {
+        const int key = static_cast<int>(engine() % 200);
+        switch (engine() % 3)
+        {
+        case 0:
+            cache.put(key, i);
+            values[key] = i;
+            break;
+        case 1:
+            cache.erase(key);
+            break;
+        default:
+            if (const auto* value = cache.find(key))
+            {
+                REQUIRE(*value == values[key]);
+            }
+        }
+        REQUIRE(cache.size() <= 64);
+    }
+    std::size_t count = 0;
+    cache.for_each([&](const int key, const int value) {
+        REQUIRE(values[key] == value);
+        ++count;
+    });
+    REQUIRE(count == cache.size());
+}
+
+TEST_CASE("test_cache_hit_rate_close_to_lru")
+{
+    constexpr std::size_t capacity = 256;
+    circbuf::ClockCache<int, int, capacity> clock;
+    LruCache lru{capacity};
+    std::mt19937 engine{11};
+    // Skewed accesses: a few keys are hot, most are rarely touched.
+    std::geometric_distribution<int> distribution{0.005};
+    std::size_t clock_hits = 0;
+    std::size_t lru_hits = 0;
+    for (int i = 0; i < 100000; ++i)
+    {
+        const int key = distribution(engine);
+        if (clock.find(key))
+        {
+            ++clock_hits;
+        }
+        else
+        {
+            clock.put(key, key);
+        }
+        if (lru.access(key))
+        {
+            ++lru_hits;
+        }
+    }
+    REQUIRE(lru_hits > 50000);
+    REQUIRE(static_cast<double>(clock_hits) >=
+            0.95 * static_cast<double>(lru_hits));
+}
+
+namespace
+{
+
+// Keys are compared by their remainder, so neither functor has a default.
+struct RemainderHash
+{
+    int divisor;
+
+    std::size_t
+    operator()(const int key) const
+    {
+        return static_cast<std::size_t>(key % divisor);
+    }
+};
+
+struct SameRemainder
+{
+    int divisor;
+
+    bool
+    operator()(const int lhs, const int rhs) const
+    {
+        return lhs % divisor == rhs % divisor;
+    }
+};
+
+} // namespace
+
+TEST_CASE("test_cache_stateful_hash")
+{
+    circbuf::ClockCache<int, int, 4, RemainderHash, SameRemainder> cache{
+        RemainderHash{3}, SameRemainder{3}};
+    cache.put(1, 10);
+    cache.put(2, 20);
+    cache.put(4, 40);
+    REQUIRE(cache.size() == 2);
+    REQUIRE(*cache.find(7) == 40);
+    REQUIRE(cache.erase(5));
+    REQUIRE(!cache.contains(2));
+    REQUIRE(!cache.contains(3));
+}
@@ -0,0 +1,214 @@
+#include "catch_amalgamated.hpp"
+#include "circbuf_channel.h"
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+// A coroutine that starts eagerly and destroys itself on completion.
+struct Task
+{
+    struct promise_type
+    {
+        Task
+        get_return_object() noexcept
+        {
+            return {};
+        }
+        std::suspend_never
+        initial_suspend() noexcept
+        {
+            return {};
+        }
+        std::suspend_never
+        final_suspend() noexcept
+        {
+            return {};
+        }
+        void
+        return_void() noexcept
+        {
+        }
+        void
+        unhandled_exception() noexcept
+        {
+            std::terminate();
+        }
+    };
+};
+
+// A single-threaded executor running resumed coroutines from a queue.
+struct Executor
+{
+    void
+    operator()(const std::coroutine_handle<> handle)
+    {
+        queue.push_back(handle);
+    }
+
+    void
+    run()
+    {
+        while (!queue.empty())
+        {
+            const auto handle = queue.front();
+            queue.pop_front();
+            handle.resume();
+        }
+    }
+
+    std::deque<std::coroutine_handle<>> queue;
+};
+
+using ExecutorChannel = circbuf::Channel<int, 2, Executor&>;
+
+Task
+produce(ExecutorChannel& channel,
+        const int first,
+        const int count,
+        std::vector<std::string>& log)
+{
+    for (int value = first; value < first + count; ++value)
+    {
+        log.push_back("push " + std::to_string(value));
+        const auto pushed = co_await channel.push(value);
+        log.push_back((pushed ? "pushed " : "rejected ") +
+                      std::to_string(value));
+    }
+}
+
+Task
+consume(ExecutorChannel& channel, std::vector<int>& values)
+{
+    while (const auto value = co_await channel.pop())
+    {
+        values.push_back(*value);
+    }
+    values.push_back(-1);
+}
+
+} // namespace
+
+TEST_CASE("test_channel_suspends_when_full")
+{
+    Executor executor;
+    ExecutorChannel channel{executor};
+    std::vector<std::string> log;
+    produce(channel, 1, 4, log);
+    // the third push waits for room
+    const std::vector<std::string> exp{
+        "push 1", "pushed 1", "push 2", "pushed 2", "push 3"};
+    REQUIRE(exp == log);
+    REQUIRE(2 == channel.size());
+    std::vector<int> values;
+    consume(channel, values);
+    executor.run();
+    REQUIRE(std::vector<int>{1, 2, 3, 4} == values);
+    REQUIRE(log.back() == "pushed 4");
+    channel.close();
+    executor.run();
+    REQUIRE(std::vector<int>{1, 2, 3, 4, -1} == values);
+}
+
+TEST_CASE("test_channel_suspends_when_empty")
+{
+    Executor executor;
+    ExecutorChannel channel{executor};
+    std::vector<int> values;
+    consume(channel, values);
+    REQUIRE(values.empty());
+    std::vector<std::string> log;
+    produce(channel, 10, 3, log);
+    executor.run();
+    REQUIRE(std::vector<int>{10, 11, 12} == values);
+    channel.close();
+    executor.run();
+    REQUIRE(-1 == values.back());
+}
+
+TEST_CASE("test_channel_close_rejects_pushes")
+{
+    Executor executor;
+    ExecutorChannel channel{executor};
+    std::vector<std::string> log;
+    produce(channel, 1, 3, log);
+    channel.close();
+    executor.run();
+    REQUIRE("rejected 3" == log.back());
+    REQUIRE(channel.closed());
+    std::vector<std::string> log2;
+    produce(channel, 7, 1, log2);
+    REQUIRE("rejected 7" == log2.back());
+    // elements pushed before closing are still delivered
+    std::vector<int> values;
+    consume(channel, values);
+    REQUIRE(std::vector<int>{1, 2, -1} == values);
+}
+
+TEST_CASE("test_channel_inline_scheduler")
+{
+    circbuf::Channel<std::unique_ptr<int>, 1> channel;
+    std::vector<int> values;
+    auto consumer = [&]() -> Task {
+        while (auto value = co_await channel.pop())
+        {
+            values.push_back(**value);
+        }
+    };
+    auto producer = [&]() -> Task {
+        for (int i = 0; i < 5; ++i)
+        {
+            co_await channel.push(std::make_unique<int>(i));
+        }
+        channel.close();
+    };
+    consumer();
+    producer();
+    REQUIRE(std::vector<int>{0, 1, 2, 3, 4} == values);
+}
+
+TEST_CASE("test_concurrent_channel")
+{
+    constexpr int producers = 4;
+    constexpr int count = 10000;
+    circbuf::ConcurrentChannel<int, 16> channel;
+    std::atomic<long long> sum{};
+    std::atomic<int> done{};
+    auto consumer = [&]() -> Task {
+        while (const auto value = co_await channel.pop())
+        {
+            sum += *value;
+        }
+        ++done;
+    };
+    auto producer = [&]() -> Task {
+        for (int i = 1; i <= count; ++i)
+        {
+            co_await channel.push(i);
+        }
+    };
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 2; ++i)
+    {
+        threads.emplace_back([&] { consumer(); });
+    }
+    for (int i = 0; i < producers; ++i)
+    {
+        threads.emplace_back([&] { producer(); });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    // all producers have been resumed to completion once their thread and
+    // every thread that resumed them have finished
+    channel.close();
+    REQUIRE(2 == done);
+    REQUIRE(producers * (count * (count + 1LL) / 2) == sum);
+}
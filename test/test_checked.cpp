@@ -0,0 +1,262 @@
+#include "catch_amalgamated.hpp"
+
+#include <stdexcept>
+
+// Failed checks throw here, so that misuse can be tested. This file is
+// built as its own program since CIRCBUF_ASSERT must be the same across a
+// program.
+#define CIRCBUF_CHECKED 1
+#define CIRCBUF_ASSERT(condition)                                              \
+    ((condition) ? void() : throw std::logic_error{#condition})
+
+#include "circbuf.h"
+#include "circbuf_bits.h"
+#include "circbuf_compressed.h"
+#include "circbuf_pool.h"
+#include "circbuf_rollup.h"
+#include "circbuf_soa.h"
+#include "circbuf_timer.h"
+#include "circbuf_tiered.h"
+#include "circbuf_window.h"
+
+#include <array>
+#include <chrono>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace
+{
+
+struct Value
+{
+    int value;
+
+    friend bool
+    operator==(const Value&, const Value&) = default;
+};
+
+struct Name
+{
+    std::string name;
+};
+
+using Buffer = circbuf::CircularBuffer<Value, 3>;
+
+} // namespace
+
+static_assert(!noexcept(std::declval<Buffer&>().front()),
+              "checked accessors may throw");
+static_assert(
+    std::is_same_v<Buffer, circbuf::abi_checked::CircularBuffer<Value, 3>>,
+    "the mode is part of the type");
+
+TEST_CASE("test_checked_empty_access")
+{
+    Buffer buf;
+    REQUIRE_THROWS_AS(buf.front(), std::logic_error);
+    REQUIRE_THROWS_AS(buf.back(), std::logic_error);
+    REQUIRE_THROWS_AS(buf.pop_front(), std::logic_error);
+    REQUIRE_THROWS_AS(std::as_const(buf).front(), std::logic_error);
+
+    circbuf::CircularBuffer<Name, 2> names;
+    REQUIRE_THROWS_AS(names.front(), std::logic_error);
+    names.push_back(Name{"a"});
+    REQUIRE(names.front().name == "a");
+}
+
+TEST_CASE("test_checked_indices")
+{
+    Buffer buf;
+    buf.push_back(Value{1});
+    buf.push_back(Value{2});
+    REQUIRE(buf[1] == Value{2});
+    REQUIRE_THROWS_AS(buf[2], std::logic_error);
+    REQUIRE_THROWS_AS(buf.erase_begin(3), std::logic_error);
+    REQUIRE_THROWS_AS(*buf.end(), std::logic_error);
+    REQUIRE_THROWS_AS(buf.begin() + 3, std::logic_error);
+    REQUIRE_THROWS_AS(buf.begin()[2], std::logic_error);
+    REQUIRE_THROWS_AS(*buf.rend(), std::logic_error);
+    REQUIRE_THROWS_AS(buf.erase(buf.end()), std::logic_error);
+    REQUIRE_THROWS_AS(buf.erase(buf.end(), buf.begin()), std::logic_error);
+}
+
+TEST_CASE("test_checked_invalidated_iterators")
+{
+    Buffer buf;
+    buf.push_back(Value{1});
+    buf.push_back(Value{2});
+
+    // Appending moves end() and shifts what reverse iterators refer to,
+    // even if the buffer is not full.
+    auto it = buf.begin();
+    auto rit = buf.rbegin();
+    auto last = buf.end();
+    buf.push_back(Value{3});
+    REQUIRE(*buf.rbegin() == Value{3});
+    REQUIRE_THROWS_AS(*rit, std::logic_error);
+    REQUIRE_THROWS_AS(rit[0], std::logic_error);
+    REQUIRE_THROWS_AS(*last, std::logic_error);
+    REQUIRE_THROWS_AS(*it, std::logic_error);
+
+    // Overwriting the front moves every element.
+    it = buf.begin();
+    buf.push_back(Value{4});
+    REQUIRE_THROWS_AS(*it, std::logic_error);
+    REQUIRE_THROWS_AS(it->value, std::logic_error);
+    REQUIRE_THROWS_AS(it + 1, std::logic_error);
+
+    it = buf.begin();
+    buf.pop_front();
+    REQUIRE_THROWS_AS(*it, std::logic_error);
+
+    it = buf.begin();
+    buf.insert(buf.begin() + 1, Value{5});
+    REQUIRE_THROWS_AS(*it, std::logic_error);
+    REQUIRE_THROWS_AS(buf.insert(it, Value{6}), std::logic_error);
+
+    it = buf.begin();
+    buf.erase(buf.begin());
+    REQUIRE_THROWS_AS(buf.erase(it), std::logic_error);
+
+    // Inserting before the front of a full buffer changes nothing.
+    buf.push_back(Value{7});
+    REQUIRE(buf.full());
+    it = buf.begin();
+    REQUIRE(buf.insert(buf.begin(), Value{8}) == buf.end());
+    REQUIRE(*it == buf.front());
+
+    rit = buf.rbegin();
+    buf.clear();
+    REQUIRE_THROWS_AS(*rit, std::logic_error);
+}
+
+TEST_CASE("test_checked_foreign_iterator")
+{
+    Buffer buf;
+    Buffer other;
+    buf.push_back(Value{1});
+    other.push_back(Value{1});
+    REQUIRE_THROWS_AS(buf.erase(other.begin()), std::logic_error);
+    REQUIRE_THROWS_AS(buf.insert(other.begin(), Value{2}), std::logic_error);
+    REQUIRE(buf.size() == 1);
+}
+
+TEST_CASE("test_checked_linearize_invalidates")
+{
+    Buffer buf;
+    buf.push_back(Value{1});
+    buf.push_back(Value{2});
+    auto it = buf.begin();
+    buf.linearize();
+    REQUIRE(*it == Value{1});
+    buf.push_back(Value{3});
+    buf.push_back(Value{4});
+    it = buf.begin();
+    buf.linearize();
+    REQUIRE_THROWS_AS(*it, std::logic_error);
+}
+
+TEST_CASE("test_checked_window_access")
+{
+    auto identity = [](const int value) { return value; };
+    circbuf::TimeWindowBuffer<int, 4, decltype(identity)> window{10, identity};
+    REQUIRE_THROWS_AS(window.front(), std::logic_error);
+    REQUIRE_THROWS_AS(window.back(), std::logic_error);
+    window.push_back(1);
+    REQUIRE(window[0] == 1);
+    REQUIRE_THROWS_AS(window[1], std::logic_error);
+}
+
+TEST_CASE("test_checked_tiered_access")
+{
+    circbuf::TieredCircularBuffer<int, 4, 2> tiered;
+    REQUIRE_THROWS_AS(tiered.back(), std::logic_error);
+    tiered.push_back(1);
+    auto it = tiered.rbegin();
+    REQUIRE(*it == 1);
+    tiered.push_back(2);
+    REQUIRE_THROWS_AS(*it, std::logic_error);
+}
+
+TEST_CASE("test_checked_pool_release")
+{
+    circbuf::SpscObjectPool<Value, 2> pool;
+    Value foreign{1};
+    REQUIRE_THROWS_AS(pool.release(&foreign), std::logic_error);
+    auto* const value = pool.acquire(Value{2});
+    REQUIRE(pool.owns(value));
+    pool.release(value);
+}
+
+TEST_CASE("test_checked_timer_expiry")
+{
+    circbuf::TimingWheel<int, 4, 2, 4> wheel;
+    const auto id = wheel.schedule(3, 1);
+    REQUIRE(wheel.expiry(*id) == 3);
+    wheel.cancel(*id);
+    REQUIRE_THROWS_AS(wheel.expiry(*id), std::logic_error);
+}
+
+TEST_CASE("test_checked_compressed_access")
+{
+    circbuf::CompressedCircularBuffer<double, 4> compressed;
+    REQUIRE_THROWS_AS(compressed.front(), std::logic_error);
+    REQUIRE_THROWS_AS(compressed.back(), std::logic_error);
+    compressed.push_back(1.5);
+    REQUIRE(compressed.front() == 1.5);
+    REQUIRE(compressed.back() == 1.5);
+    compressed.clear();
+    REQUIRE_THROWS_AS(compressed.back(), std::logic_error);
+}
+
+TEST_CASE("test_checked_copy_linear")
+{
+    Buffer buf;
+    buf.push_back(Value{1});
+    buf.push_back(Value{2});
+    std::array<Value, 2> enough{};
+    REQUIRE(buf.copy_linear(enough) == 2);
+    std::array<Value, 1> short_of_one{};
+    REQUIRE_THROWS_AS(buf.copy_linear(short_of_one), std::logic_error);
+}
+
+TEST_CASE("test_checked_bits_access")
+{
+    circbuf::BitCircularBuffer<8> bits;
+    REQUIRE_THROWS_AS(bits.front(), std::logic_error);
+    REQUIRE_THROWS_AS(bits.back(), std::logic_error);
+    REQUIRE_THROWS_AS(bits.pop_front(), std::logic_error);
+    bits.push_back(true);
+    REQUIRE(bits[0]);
+    REQUIRE_THROWS_AS(bits[1], std::logic_error);
+    REQUIRE_THROWS_AS(bits.set(1, true), std::logic_error);
+    REQUIRE(bits.size() == 1);
+}
+
+TEST_CASE("test_checked_empty_rollup_average")
+{
+    using Seconds = std::chrono::sys_seconds;
+    circbuf::RollupBuffer<int, 4, 2, Seconds> rollups{
+        {std::chrono::seconds{1}, std::chrono::seconds{10}}};
+    REQUIRE_THROWS_AS(rollups.current(0).average(), std::logic_error);
+    rollups.add(Seconds{std::chrono::seconds{3}}, 7);
+    REQUIRE(rollups.current(0).average() == 7);
+    REQUIRE_THROWS_AS(rollups.current(1).average(), std::logic_error);
+}
+
+TEST_CASE("test_checked_soa_access")
+{
+    circbuf::SoaCircularBuffer<3, int, double> soa;
+    REQUIRE_THROWS_AS(soa.front(), std::logic_error);
+    REQUIRE_THROWS_AS(soa.back(), std::logic_error);
+    REQUIRE_THROWS_AS(soa.pop_front(), std::logic_error);
+    soa.push_back(1, 1.5);
+    REQUIRE(soa.get<1>(0) == 1.5);
+    REQUIRE_THROWS_AS(soa.get<0>(1), std::logic_error);
+    REQUIRE_THROWS_AS(soa[1], std::logic_error);
+    REQUIRE_THROWS_AS(*soa.end(), std::logic_error);
+    REQUIRE_THROWS_AS(std::as_const(soa)[1], std::logic_error);
+    REQUIRE(std::get<0>(soa.pop_front()) == 1);
+    REQUIRE(soa.empty());
+}
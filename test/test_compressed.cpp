@@ -0,0 +1,136 @@
+#include "catch_amalgamated.hpp"
+#include "circbuf_compressed.h"
+
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+template <typename Buffer>
+std::vector<typename Buffer::value_type>
+forward(const Buffer& buffer)
+{
+    std::vector<typename Buffer::value_type> values;
+    for (const auto value : buffer)
+    {
+        values.push_back(value);
+    }
+    return values;
+}
+
+template <typename Buffer>
+std::vector<typename Buffer::value_type>
+backward(const Buffer& buffer)
+{
+    std::vector<typename Buffer::value_type> values;
+    for (auto it = buffer.rbegin(); it != buffer.rend(); ++it)
+    {
+        values.push_back(*it);
+    }
+    return values;
+}
+
+template <typename Buffer, typename Generator>
+void
+check_roundtrip(Generator generate)
+{
+    Buffer buffer;
+    std::deque<typename Buffer::value_type> exp;
+    for (int i = 0; i < 20000; ++i)
+    {
+        const auto value = generate(i);
+        buffer.push_back(value);
+        exp.push_back(value);
+    }
+    // whole blocks were evicted, the newest values are all present
+    while (exp.size() > buffer.size())
+    {
+        exp.pop_front();
+    }
+    REQUIRE(buffer.blocks() == buffer.max_blocks());
+    REQUIRE(exp.front() == buffer.front());
+    REQUIRE(exp.back() == buffer.back());
+    REQUIRE(std::vector<typename Buffer::value_type>(exp.begin(), exp.end()) ==
+            forward(buffer));
+    REQUIRE(std::vector<typename Buffer::value_type>(exp.rbegin(),
+                                                     exp.rend()) ==
+            backward(buffer));
+}
+
+} // namespace
+
+TEST_CASE("test_compressed_empty")
+{
+    circbuf::CompressedCircularBuffer<double, 4> buffer;
+    REQUIRE(buffer.empty());
+    REQUIRE(buffer.begin() == buffer.end());
+    REQUIRE(buffer.rbegin() == buffer.rend());
+    buffer.push_back(1.5);
+    REQUIRE(std::vector<double>{1.5} == forward(buffer));
+    REQUIRE(std::vector<double>{1.5} == backward(buffer));
+    buffer.clear();
+    REQUIRE(0 == buffer.size());
+    REQUIRE(buffer.begin() == buffer.end());
+    buffer.push_back(2.5);
+    REQUIRE(2.5 == buffer.back());
+}
+
+TEST_CASE("test_compressed_doubles")
+{
+    using Buffer = circbuf::CompressedCircularBuffer<double, 8>;
+    check_roundtrip<Buffer>([](const int i) {
+        return 20.0 + std::round(std::sin(i * 0.01) * 8) / 4;
+    });
+    std::mt19937_64 engine{1};
+    std::normal_distribution<double> noise;
+    check_roundtrip<Buffer>([&](int) { return noise(engine); });
+    check_roundtrip<Buffer>([](const int i) {
+        return i % 3 == 0 ? std::numeric_limits<double>::infinity()
+                          : -0.0 + i;
+    });
+}
+
+TEST_CASE("test_compressed_floats")
+{
+    using Buffer = circbuf::CompressedCircularBuffer<float, 4, 64, 16>;
+    check_roundtrip<Buffer>([](const int i) { return 1.0f + float(i % 7); });
+}
+
+TEST_CASE("test_compressed_integers")
+{
+    using Buffer = circbuf::CompressedCircularBuffer<std::int64_t, 8>;
+    check_roundtrip<Buffer>(
+        [](const int i) { return std::int64_t{1'700'000'000'000} + i * 1000; });
+    std::mt19937_64 engine{2};
+    check_roundtrip<Buffer>(
+        [&](int) { return static_cast<std::int64_t>(engine()); });
+    check_roundtrip<circbuf::CompressedCircularBuffer<std::uint8_t, 3>>(
+        [](const int i) { return static_cast<std::uint8_t>(i * 7); });
+    check_roundtrip<circbuf::CompressedCircularBuffer<int, 5>>([](const int i) {
+        return i % 2 == 0 ? std::numeric_limits<int>::min()
+                          : std::numeric_limits<int>::max();
+    });
+}
+
+TEST_CASE("test_compressed_ratio")
+{
+    // a regular timestamp series takes one bit per value
+    circbuf::CompressedCircularBuffer<std::int64_t, 16, 256, 1024> timestamps;
+    for (std::int64_t i = 0; i < 1000; ++i)
+    {
+        timestamps.push_back(1'700'000'000 + i * 10);
+    }
+    REQUIRE(1 == timestamps.blocks());
+    // a slowly changing series of doubles packs many values into a block
+    circbuf::CompressedCircularBuffer<double, 16> values;
+    for (int i = 0; i < 1280; ++i)
+    {
+        values.push_back(i / 128 * 0.5);
+    }
+    REQUIRE(10 == values.blocks());
+}
@@ -0,0 +1,286 @@
+#include "catch_amalgamated.hpp"
+#include "circbuf_keyed.h"
+
+#include <cstddef>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+using Trades = circbuf::KeyedCircularBuffer<int, double, 3>;
+
+template <typename Buffer>
+std::vector<typename Buffer::value_type>
+values(const Buffer& history)
+{
+    return {history.begin(), history.end()};
+}
+
+} // namespace
+
+TEST_CASE("test_keyed_push_and_history")
+{
+    Trades trades;
+    REQUIRE(trades.empty());
+    REQUIRE(trades.find(1) == nullptr);
+    trades.push(1, 1.0);
+    trades.push(2, 20.0);
+    trades.push(1, 2.0);
+    trades.push(1, 3.0);
+    trades.push(1, 4.0);
+    REQUIRE(trades.size() == 2);
+    REQUIRE(trades.slots() == 2);
+    REQUIRE(trades.contains(1));
+    REQUIRE(!trades.contains(3));
+    REQUIRE(values(trades.history(1)) == std::vector<double>{2.0, 3.0, 4.0});
+    REQUIRE(values(trades.history(2)) == std::vector<double>{20.0});
+    REQUIRE(trades.find(2) == &trades.history(2));
+}
+
+TEST_CASE("test_keyed_emplace")
+{
+    circbuf::KeyedCircularBuffer<std::string, std::string, 2> names;
+    names.emplace("a", 3, 'x');
+    REQUIRE(names.history("a").back() == "xxx");
+    names.push("a", std::string{"y"});
+    names.emplace("a", "z");
+    REQUIRE(std::vector<std::string>(names.history("a").begin(),
+                                     names.history("a").end()) ==
+            std::vector<std::string>{"y", "z"});
+}
+
+TEST_CASE("test_keyed_retire_reuses_slots")
+{
+    Trades trades{4};
+    trades.push(1, 1.0);
+    trades.push(2, 2.0);
+    trades.push(3, 3.0);
+    REQUIRE(trades.retire(2));
+    REQUIRE(!trades.retire(2));
+    REQUIRE(!trades.contains(2));
+    REQUIRE(trades.size() == 2);
+    REQUIRE(trades.slots() == 3);
+
+    trades.push(4, 4.0);
+    REQUIRE(trades.slots() == 3);
+    REQUIRE(values(trades.history(4)) == std::vector<double>{4.0});
+
+    // A retired key starts over with an empty history.
+    trades.push(2, 5.0);
+    REQUIRE(trades.slots() == 4);
+    REQUIRE(values(trades.history(2)) == std::vector<double>{5.0});
+
+    trades.clear();
+    REQUIRE(trades.empty());
+    REQUIRE(trades.slots() == 0);
+}
+
+TEST_CASE("test_keyed_for_each_in_arena_order")
+{
+    Trades trades;
+    for (int key = 0; key < 5; ++key)
+    {
+        trades.push(key, key * 10.0);
+        trades.push(key, key * 10.0 + 1);
+    }
+    trades.retire(1);
+    trades.retire(3);
+    trades.push(7, 70.0);
+
+    std::vector<std::pair<int, std::vector<double>>> seen;
+    trades.for_each([&](const int key, const Trades::buffer_type& history) {
+        seen.emplace_back(key, values(history));
+    });
+    REQUIRE(seen == std::vector<std::pair<int, std::vector<double>>>{
+                        {0, {0.0, 1.0}},
+                        {2, {20.0, 21.0}},
+                        {7, {70.0}},
+                        {4, {40.0, 41.0}},
+                    });
+}
+
+TEST_CASE("test_keyed_against_map")
+{
+    Trades trades;
+    std::map<int, std::vector<double>> expected;
+    for (int i = 0; i < 1000; ++i)
+    {
+        const int key = (i * 7) % 13;
+        if (i % 17 == 0)
+        {
+            REQUIRE(trades.retire(key) == (expected.erase(key) == 1));
+            continue;
+        }
+        trades.push(key, i);
+        auto& history = expected[key];
+        history.push_back(i);
+        if (history.size() > 3)
+        {
+            history.erase(history.begin());
+        }
+    }
+    REQUIRE(trades.size() == expected.size());
+    REQUIRE(trades.slots() <= 13);
+    for (const auto& [key, history] : expected)
+    {
+        REQUIRE(values(trades.history(key)) == history);
+    }
+}
+
+namespace
+{
+
+// Sends every key to the same home position of the table.
+struct Collide
+{
+    std::size_t
+    operator()(int) const noexcept
+    {
+        return 0;
+    }
+};
+
+bool throw_on_copy = false;
+
+struct FragileKey
+{
+    explicit FragileKey(const int id)
+        : id{id}
+    {
+    }
+
+    FragileKey(const FragileKey& other)
+        : id{other.id}
+    {
+        if (throw_on_copy)
+        {
+            throw std::runtime_error{"copy"};
+        }
+    }
+
+    FragileKey&
+    operator=(const FragileKey& other)
+    {
+        if (throw_on_copy)
+        {
+            throw std::runtime_error{"copy"};
+        }
+        id = other.id;
+        return *this;
+    }
+
+    friend bool
+    operator==(const FragileKey&, const FragileKey&) = default;
+
+    int id;
+};
+
+struct FragileHash
+{
+    std::size_t
+    operator()(const FragileKey& key) const noexcept
+    {
+        return static_cast<std::size_t>(key.id);
+    }
+};
+
+} // namespace
+
+TEST_CASE("test_keyed_colliding_keys")
+{
+    circbuf::KeyedCircularBuffer<int, int, 2, Collide> rings;
+    std::map<int, int> expected;
+    for (int i = 0; i < 2000; ++i)
+    {
+        const int key = (i * 31) % 97;
+        if (i % 5 == 0)
+        {
+            REQUIRE(rings.retire(key) == (expected.erase(key) == 1));
+            continue;
+        }
+        rings.push(key, i);
+        expected[key] = i;
+    }
+    REQUIRE(rings.size() == expected.size());
+    for (int key = 0; key < 97; ++key)
+    {
+        const auto* history = rings.find(key);
+        REQUIRE((history != nullptr) == expected.contains(key));
+        if (history)
+        {
+            REQUIRE(history->back() == expected[key]);
+        }
+    }
+}
+
+TEST_CASE("test_keyed_throwing_key_leaves_no_orphan")
+{
+    circbuf::KeyedCircularBuffer<FragileKey, int, 2, FragileHash> rings;
+    rings.push(FragileKey{1}, 10);
+    rings.push(FragileKey{2}, 20);
+
+    throw_on_copy = true;
+    REQUIRE_THROWS_AS(rings.push(FragileKey{3}, 30), std::runtime_error);
+    throw_on_copy = false;
+    REQUIRE(rings.size() == 2);
+    REQUIRE(rings.slots() == 2);
+    REQUIRE(!rings.contains(FragileKey{3}));
+
+    // A failed push into a free slot keeps the slot free.
+    REQUIRE(rings.retire(FragileKey{1}));
+    throw_on_copy = true;
+    REQUIRE_THROWS_AS(rings.push(FragileKey{4}, 40), std::runtime_error);
+    throw_on_copy = false;
+    REQUIRE(!rings.contains(FragileKey{4}));
+    rings.push(FragileKey{5}, 50);
+    REQUIRE(rings.slots() == 2);
+    REQUIRE(rings.history(FragileKey{5}).back() == 50);
+    REQUIRE(rings.size() == 2);
+}
+
+namespace
+{
+
+// Keys are compared by their remainder, so neither functor has a default.
+struct RemainderHash
+{
+    int divisor;
+
+    std::size_t
+    operator()(const int key) const
+    {
+        return static_cast<std::size_t>(key % divisor);
+    }
+};
+
+struct SameRemainder
+{
+    int divisor;
+
+    bool
+    operator()(const int lhs, const int rhs) const
+    {
+        return lhs % divisor == rhs % divisor;
+    }
+};
+
+} // namespace
+
+TEST_CASE("test_keyed_stateful_hash")
+{
+    circbuf::KeyedCircularBuffer<int, int, 4, RemainderHash, SameRemainder>
+        rings{0, RemainderHash{10}, SameRemainder{10}};
+    for (int key = 0; key < 100; ++key)
+    {
+        rings.push(key, key);
+    }
+    REQUIRE(rings.size() == 10);
+    REQUIRE(values(rings.history(3)) == std::vector<int>{63, 73, 83, 93});
+    REQUIRE(rings.retire(13));
+    REQUIRE(!rings.contains(3));
+    REQUIRE(rings.contains(4));
+}
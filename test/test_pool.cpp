@@ -0,0 +1,172 @@
+#include "catch_amalgamated.hpp"
+#include "circbuf_pool.h"
+#include "circbuf_spsc.h"
+
+#include <atomic>
+#include <cstdint>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+struct Message
+{
+    explicit Message(const std::uint64_t id) noexcept
+        : id{id}
+    {
+        ++live;
+    }
+
+    ~Message()
+    {
+        --live;
+    }
+
+    inline static std::atomic<int> live{};
+
+    std::uint64_t id;
+    alignas(32) char payload[40]{};
+};
+
+} // namespace
+
+TEST_CASE("test_mpmc_push_pop")
+{
+    circbuf::MpmcCircularBuffer<int, 3> queue;
+    REQUIRE(!queue.try_pop());
+    REQUIRE(queue.try_push(1));
+    REQUIRE(queue.try_push(2));
+    REQUIRE(queue.try_push(3));
+    REQUIRE(!queue.try_push(4));
+    REQUIRE(1 == queue.try_pop());
+    REQUIRE(queue.try_push(4));
+    REQUIRE(2 == queue.try_pop());
+    REQUIRE(3 == queue.try_pop());
+    REQUIRE(4 == queue.try_pop());
+    REQUIRE(!queue.try_pop());
+}
+
+TEST_CASE("test_pool_acquire_release")
+{
+    circbuf::SpscObjectPool<Message, 3> pool;
+    std::set<Message*> objects;
+    for (std::uint64_t id = 0; id < 3; ++id)
+    {
+        auto* message = pool.acquire(id);
+        REQUIRE(message);
+        REQUIRE(message->id == id);
+        REQUIRE(pool.owns(message));
+        REQUIRE(reinterpret_cast<std::uintptr_t>(message) %
+                    alignof(Message) ==
+                0);
+        objects.insert(message);
+    }
+    REQUIRE(objects.size() == 3);
+    REQUIRE(Message::live == 3);
+    REQUIRE(!pool.acquire(std::uint64_t{3}));
+
+    auto* first = *objects.begin();
+    pool.release(first);
+    REQUIRE(Message::live == 2);
+    auto* again = pool.acquire(std::uint64_t{4});
+    REQUIRE(again == first);
+    REQUIRE(again->id == 4);
+    for (auto* message : objects)
+    {
+        pool.release(message);
+    }
+    REQUIRE(Message::live == 0);
+
+    Message outside{5};
+    REQUIRE(!pool.owns(&outside));
+}
+
+TEST_CASE("test_pool_spsc_threads")
+{
+    constexpr std::uint64_t count = 20000;
+    circbuf::SpscObjectPool<Message, 16> pool;
+    circbuf::SpscCircularBuffer<Message*, 16> queue;
+    std::uint64_t sum = 0;
+    std::thread sender{[&] {
+        for (std::uint64_t received = 0; received < count;)
+        {
+            if (const auto message = queue.try_pop())
+            {
+                sum += (*message)->id;
+                pool.release(*message);
+                ++received;
+            }
+            else
+            {
+                std::this_thread::yield();
+            }
+        }
+    }};
+    for (std::uint64_t id = 0; id < count;)
+    {
+        auto* message = pool.acquire(id);
+        if (!message)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        while (!queue.try_push(message))
+        {
+            std::this_thread::yield();
+        }
+        ++id;
+    }
+    sender.join();
+    REQUIRE(sum == count * (count - 1) / 2);
+    REQUIRE(Message::live == 0);
+}
+
+TEST_CASE("test_pool_mpmc_threads")
+{
+    constexpr int threads = 4;
+    constexpr int rounds = 5000;
+    circbuf::MpmcObjectPool<Message, 8> pool;
+    std::atomic<int> failures{};
+    std::vector<std::thread> workers;
+    for (int thread = 0; thread < threads; ++thread)
+    {
+        workers.emplace_back([&, thread] {
+            for (int round = 0; round < rounds;)
+            {
+                const auto id = static_cast<std::uint64_t>(thread);
+                auto* message = pool.acquire(id);
+                if (!message)
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+                std::this_thread::yield();
+                if (message->id != id)
+                {
+                    ++failures;
+                }
+                pool.release(message);
+                ++round;
+            }
+        });
+    }
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+    REQUIRE(failures == 0);
+    REQUIRE(Message::live == 0);
+    std::set<Message*> objects;
+    for (int i = 0; i < 8; ++i)
+    {
+        objects.insert(pool.acquire(std::uint64_t{0}));
+    }
+    REQUIRE(!objects.count(nullptr));
+    REQUIRE(objects.size() == 8);
+    for (auto* message : objects)
+    {
+        pool.release(message);
+    }
+}
@@ -0,0 +1,160 @@
+#include "catch_amalgamated.hpp"
+#include "circbuf_rollup.h"
+
+#include <chrono>
+#include <vector>
+
+namespace
+{
+
+using namespace std::chrono_literals;
+
+using Seconds = std::chrono::sys_seconds;
+using Dashboard = circbuf::RollupBuffer<double, 8, 3, Seconds>;
+
+Seconds
+at(const long seconds)
+{
+    return Seconds{std::chrono::seconds{seconds}};
+}
+
+template <typename Range>
+std::vector<long>
+starts(const Range& range)
+{
+    std::vector<long> result;
+    for (const auto& rollup : range)
+    {
+        result.push_back(rollup.start.time_since_epoch().count());
+    }
+    return result;
+}
+
+} // namespace
+
+TEST_CASE("test_rollup_consolidates")
+{
+    Dashboard dash{{1s, 10s, 60s}};
+    dash.add(at(0), 4.0);
+    dash.add(at(0), 2.0);
+    dash.add(at(1), 3.0);
+    REQUIRE(dash.level(0).size() == 1);
+    const auto& first = dash.level(0).front();
+    REQUIRE(first.start == at(0));
+    REQUIRE(first.min == 2.0);
+    REQUIRE(first.max == 4.0);
+    REQUIRE(first.last == 2.0);
+    REQUIRE(first.count == 2);
+    REQUIRE(first.average() == 3.0);
+    REQUIRE(dash.level(1).empty());
+    REQUIRE(dash.current(1).count == 2);
+
+    dash.add(at(12), 9.0);
+    REQUIRE(starts(dash.level(0)) == std::vector<long>{0, 1});
+    REQUIRE(dash.level(1).size() == 1);
+    const auto& tens = dash.level(1).front();
+    REQUIRE(tens.start == at(0));
+    REQUIRE(tens.min == 2.0);
+    REQUIRE(tens.max == 4.0);
+    REQUIRE(tens.last == 3.0);
+    REQUIRE(tens.count == 3);
+    REQUIRE(tens.sum == 9.0);
+    REQUIRE(dash.current(0).start == at(12));
+    REQUIRE(dash.current(1).count == 0);
+    REQUIRE(dash.current(2).count == 3);
+
+    dash.add(at(75), 1.0);
+    REQUIRE(starts(dash.level(1)) == std::vector<long>{0, 10});
+    REQUIRE(starts(dash.level(2)) == std::vector<long>{0});
+    REQUIRE(dash.level(2).front().count == 4);
+    REQUIRE(dash.level(2).front().max == 9.0);
+    REQUIRE(dash.level(2).front().last == 9.0);
+}
+
+TEST_CASE("test_rollup_flush")
+{
+    Dashboard dash{{1s, 10s, 60s}};
+    dash.add(at(5), 1.0);
+    dash.add(at(6), 2.0);
+    dash.flush();
+    REQUIRE(starts(dash.level(0)) == std::vector<long>{5, 6});
+    REQUIRE(starts(dash.level(1)) == std::vector<long>{0});
+    REQUIRE(starts(dash.level(2)) == std::vector<long>{0});
+    REQUIRE(dash.level(2).front().count == 2);
+    for (std::size_t level = 0; level < Dashboard::levels(); ++level)
+    {
+        REQUIRE(dash.current(level).count == 0);
+    }
+    dash.clear();
+    REQUIRE(dash.level(0).empty());
+    REQUIRE(dash.level(2).empty());
+}
+
+TEST_CASE("test_rollup_rings_keep_last_slots")
+{
+    Dashboard dash{{1s, 10s, 60s}};
+    for (long second = 0; second < 100; ++second)
+    {
+        dash.add(at(second), static_cast<double>(second));
+    }
+    REQUIRE(starts(dash.level(0)) ==
+            std::vector<long>{91, 92, 93, 94, 95, 96, 97, 98});
+    REQUIRE(starts(dash.level(1)) ==
+            std::vector<long>{10, 20, 30, 40, 50, 60, 70, 80});
+    REQUIRE(starts(dash.level(2)) == std::vector<long>{0});
+    REQUIRE(dash.level(1).back().min == 80.0);
+    REQUIRE(dash.level(1).back().max == 89.0);
+    REQUIRE(dash.level(1).back().average() == 84.5);
+}
+
+TEST_CASE("test_rollup_query_picks_resolution")
+{
+    Dashboard dash{{1s, 10s, 60s}};
+    for (long second = 0; second < 200; ++second)
+    {
+        dash.add(at(second), 1.0);
+    }
+    // Fine enough and covering the range.
+    auto range = dash.query(at(192), at(196), 1s);
+    REQUIRE(range.level == 0);
+    REQUIRE(starts(range) == std::vector<long>{192, 193, 194, 195});
+
+    // Coarsest level not coarser than the step.
+    range = dash.query(at(150), at(180), 30s);
+    REQUIRE(range.level == 1);
+    REQUIRE(starts(range) == std::vector<long>{150, 160, 170});
+
+    // The finest ring no longer reaches back that far.
+    range = dash.query(at(110), at(130), 1s);
+    REQUIRE(range.level == 1);
+    REQUIRE(starts(range) == std::vector<long>{110, 120});
+
+    range = dash.query(at(0), at(200), 1s);
+    REQUIRE(range.level == 2);
+    REQUIRE(starts(range) == std::vector<long>{0, 60, 120});
+
+    // Partially overlapping intervals are included.
+    range = dash.query(at(155), at(161), 10s);
+    REQUIRE(starts(range) == std::vector<long>{150, 160});
+
+    range = dash.query(at(500), at(600), 10s);
+    REQUIRE(range.empty());
+}
+
+TEST_CASE("test_rollup_aggregate")
+{
+    circbuf::RollupBuffer<long, 16, 2, long> counts{{1, 4}};
+    for (long time = 0; time < 12; ++time)
+    {
+        counts.add(time, time);
+    }
+    const auto total = counts.aggregate(0, 8, 4);
+    REQUIRE(total.start == 0);
+    REQUIRE(total.min == 0);
+    REQUIRE(total.max == 7);
+    REQUIRE(total.sum == 28);
+    REQUIRE(total.last == 7);
+    REQUIRE(total.count == 8);
+    REQUIRE(counts.aggregate(2, 5, 1).sum == 2 + 3 + 4);
+    REQUIRE(counts.aggregate(20, 30, 1).count == 0);
+}
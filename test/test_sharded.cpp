@@ -0,0 +1,116 @@
+#include "catch_amalgamated.hpp"
+#include "circbuf_sharded.h"
+
+#include <algorithm>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+TEST_CASE("test_sharded_push_to_shard")
+{
+    circbuf::ShardedCircularBuffer<int, 3, 4> buffer;
+    REQUIRE(12 == buffer.max_size());
+    REQUIRE(0 == buffer.size());
+    buffer.emplace_back_to(0, 1);
+    buffer.emplace_back_to(2, 2);
+    buffer.emplace_back_to(2, 3);
+    REQUIRE(3 == buffer.size());
+    std::vector<std::size_t> sizes;
+    buffer.for_each_shard([&](const auto& shard) {
+        sizes.push_back(shard.size());
+    });
+    REQUIRE(std::vector<std::size_t>{1, 0, 2, 0} == sizes);
+    buffer.clear();
+    REQUIRE(0 == buffer.size());
+}
+
+TEST_CASE("test_sharded_merge")
+{
+    circbuf::ShardedCircularBuffer<int, 4, 3> buffer;
+    for (const int value : {1, 4, 9})
+    {
+        buffer.emplace_back_to(0, value);
+    }
+    for (const int value : {2, 3, 10, 11, 12})
+    {
+        buffer.emplace_back_to(1, value); // 2 is overwritten
+    }
+    decltype(buffer)::snapshot_type snapshot;
+    buffer.snapshot(snapshot);
+    std::vector<int> merged;
+    for (const auto value : circbuf::merge(snapshot))
+    {
+        merged.push_back(value);
+    }
+    REQUIRE(std::vector<int>{1, 3, 4, 9, 10, 11, 12} == merged);
+}
+
+TEST_CASE("test_sharded_merge_is_stable")
+{
+    using Entry = std::pair<int, int>;
+    std::array<circbuf::CircularBuffer<Entry, 4>, 3> buffers;
+    buffers[0].push_back({1, 0});
+    buffers[0].push_back({2, 0});
+    buffers[1].push_back({1, 1});
+    buffers[2].push_back({0, 2});
+    buffers[2].push_back({2, 2});
+    auto by_key = [](const Entry& lhs, const Entry& rhs) {
+        return lhs.first < rhs.first;
+    };
+    std::vector<Entry> merged;
+    std::vector<std::size_t> shards;
+    const auto range = circbuf::merge(buffers, by_key);
+    for (auto it = range.begin(); it != range.end(); ++it)
+    {
+        merged.push_back(*it);
+        shards.push_back(it.shard());
+    }
+    const std::vector<Entry> exp{{0, 2}, {1, 0}, {1, 1}, {2, 0}, {2, 2}};
+    REQUIRE(exp == merged);
+    REQUIRE(std::vector<std::size_t>{2, 0, 1, 0, 2} == shards);
+}
+
+TEST_CASE("test_sharded_merge_empty")
+{
+    const std::array<circbuf::CircularBuffer<int, 2>, 2> buffers{};
+    const auto range = circbuf::merge(buffers);
+    REQUIRE(range.begin() == range.end());
+}
+
+TEST_CASE("test_sharded_concurrent_push")
+{
+    constexpr int threads = 8;
+    constexpr int count = 1000;
+    circbuf::ShardedCircularBuffer<int, threads * count, 4> buffer;
+    std::vector<std::thread> writers;
+    for (int t = 0; t < threads; ++t)
+    {
+        writers.emplace_back([&buffer, t] {
+            for (int i = 0; i < count; ++i)
+            {
+                buffer.push_back(t * count + i);
+            }
+        });
+    }
+    for (auto& writer : writers)
+    {
+        writer.join();
+    }
+    REQUIRE(threads * count == buffer.size());
+    // every thread pushes increasing values, so each shard holds increasing
+    // runs per thread; sorting the merge must yield all values exactly once
+    const auto snapshot =
+        std::make_unique<decltype(buffer)::snapshot_type>();
+    buffer.snapshot(*snapshot);
+    std::vector<int> values;
+    for (const auto value : circbuf::merge(*snapshot))
+    {
+        values.push_back(value);
+    }
+    std::sort(values.begin(), values.end());
+    for (int i = 0; i < threads * count; ++i)
+    {
+        REQUIRE(i == values[static_cast<std::size_t>(i)]);
+    }
+}
@@ -0,0 +1,113 @@
+#include "catch_amalgamated.hpp"
+#include "circbuf_soa.h"
+
+#include <cstdint>
+#include <numeric>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+using Ticks = circbuf::SoaCircularBuffer<4, std::int64_t, double, int>;
+
+double
+sum_prices(const Ticks& ticks)
+{
+    double sum{};
+    for (const auto segment : ticks.column<1>())
+    {
+        sum = std::accumulate(segment.begin(), segment.end(), sum);
+    }
+    return sum;
+}
+
+consteval auto
+consteval_soa_push_and_pop()
+{
+    circbuf::SoaCircularBuffer<2, int, long> buf;
+    buf.push_back(1, 10L);
+    buf.push_back(2, 20L);
+    buf.push_back(3, 30L);
+    const auto [id, value] = buf.pop_front();
+    return id + value + buf.get<1>(0);
+}
+
+static_assert(2 + 20 + 30 == consteval_soa_push_and_pop());
+
+} // namespace
+
+TEST_CASE("test_soa_roundtrip")
+{
+    Ticks ticks;
+    REQUIRE(4 == ticks.max_size());
+    REQUIRE(ticks.empty());
+    ticks.push_back(1, 10.5, 100);
+    ticks.push_back(std::tuple<std::int64_t, double, int>{2, 11.5, 200});
+    REQUIRE(2 == ticks.size());
+    auto [ts, price, size] = ticks.front();
+    REQUIRE(1 == ts);
+    REQUIRE(10.5 == price);
+    REQUIRE(100 == size);
+    REQUIRE(2 == std::get<0>(ticks.back()));
+    REQUIRE(11.5 == ticks.get<1>(1));
+    std::get<2>(ticks[1]) = 250;
+    REQUIRE(250 == std::as_const(ticks).get<2>(1));
+    const auto popped = ticks.pop_front();
+    REQUIRE(std::tuple<std::int64_t, double, int>{1, 10.5, 100} == popped);
+    REQUIRE(1 == ticks.size());
+    ticks.clear();
+    REQUIRE(ticks.empty());
+}
+
+TEST_CASE("test_soa_overwrite_and_columns")
+{
+    Ticks ticks;
+    for (int i = 0; i < 6; ++i)
+    {
+        ticks.push_back(i, i + 0.5, i * 10);
+    }
+    REQUIRE(ticks.full());
+    REQUIRE(2 == std::get<0>(ticks.front()));
+    REQUIRE(5 == std::get<0>(ticks.back()));
+    const auto prices = ticks.column<1>();
+    REQUIRE(2 == prices[0].size());
+    REQUIRE(2 == prices[1].size());
+    REQUIRE(2.5 == prices[0][0]);
+    REQUIRE(4.5 == prices[1][0]);
+    REQUIRE(2.5 + 3.5 + 4.5 + 5.5 == sum_prices(ticks));
+    for (auto segment : ticks.column<2>())
+    {
+        for (auto& size : segment)
+        {
+            size += 1;
+        }
+    }
+    REQUIRE(21 == ticks.get<2>(0));
+    REQUIRE(51 == ticks.get<2>(3));
+}
+
+TEST_CASE("test_soa_iteration")
+{
+    circbuf::SoaCircularBuffer<3, int, std::string> buf;
+    for (int id = 1; id <= 4; ++id)
+    {
+        buf.push_back(id, std::string(1, static_cast<char>('a' + id - 1)));
+    }
+    std::vector<std::string> names;
+    for (auto [id, name] : buf)
+    {
+        names.push_back(name + std::to_string(id));
+    }
+    const std::vector<std::string> exp{"b2", "c3", "d4"};
+    REQUIRE(exp == names);
+    for (auto [id, name] : buf)
+    {
+        id *= 2;
+    }
+    REQUIRE(8 == buf.get<0>(2));
+    const auto& cbuf = buf;
+    REQUIRE(cbuf.end() - cbuf.begin() == 3);
+    REQUIRE("c" == std::get<1>(*(cbuf.begin() + 1)));
+    REQUIRE("d" == std::get<1>(cbuf.begin()[2]));
+}
@@ -0,0 +1,185 @@
+#include "catch_amalgamated.hpp"
+#include "circbuf_spsc.h"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+template <typename Segments>
+std::vector<int>
+to_vector(const Segments& segments)
+{
+    std::vector<int> values;
+    for (const auto segment : segments)
+    {
+        values.insert(values.end(), segment.begin(), segment.end());
+    }
+    return values;
+}
+
+} // namespace
+
+TEST_CASE("test_spsc_push_pop")
+{
+    circbuf::SpscCircularBuffer<int, 2> queue;
+    REQUIRE(queue.empty());
+    REQUIRE(!queue.try_pop());
+    REQUIRE(queue.try_push(1));
+    REQUIRE(queue.try_push(2));
+    REQUIRE(!queue.try_push(3));
+    REQUIRE(2 == queue.size());
+    REQUIRE(1 == queue.try_pop());
+    REQUIRE(queue.try_push(3));
+    REQUIRE(2 == queue.try_pop());
+    REQUIRE(3 == queue.try_pop());
+    REQUIRE(queue.empty());
+}
+
+TEST_CASE("test_spsc_claim_publish")
+{
+    circbuf::SpscCircularBuffer<int, 5> queue;
+    auto slots = queue.claim(3);
+    REQUIRE(3 == slots[0].size());
+    REQUIRE(slots[1].empty());
+    slots[0][0] = 1;
+    slots[0][1] = 2;
+    // nothing is visible before publishing
+    REQUIRE(queue.peek_batch(5)[0].empty());
+    queue.publish(2);
+    REQUIRE(std::vector<int>{1, 2} == to_vector(queue.peek_batch(5)));
+    queue.consume(2);
+    // the claim wraps around the end of the storage
+    slots = queue.claim(10);
+    REQUIRE(3 == slots[0].size());
+    REQUIRE(2 == slots[1].size());
+    int value = 3;
+    for (const auto segment : slots)
+    {
+        for (auto& slot : segment)
+        {
+            slot = value++;
+        }
+    }
+    queue.publish(5);
+    REQUIRE(queue.claim(1)[0].empty());
+    const auto batch = queue.peek_batch(4);
+    REQUIRE(std::vector<int>{3, 4, 5} == std::vector<int>(batch[0].begin(),
+                                                          batch[0].end()));
+    REQUIRE(std::vector<int>{6} == std::vector<int>(batch[1].begin(),
+                                                    batch[1].end()));
+    queue.consume(4);
+    REQUIRE(7 == queue.try_pop());
+    REQUIRE(queue.empty());
+}
+
+TEST_CASE("test_spsc_move_only")
+{
+    circbuf::SpscCircularBuffer<std::unique_ptr<int>, 3> queue;
+    REQUIRE(queue.try_push(std::make_unique<int>(42)));
+    auto value = queue.try_pop();
+    REQUIRE(value);
+    REQUIRE(42 == **value);
+}
+
+TEST_CASE("test_spsc_concurrent_batches")
+{
+    constexpr int count = 100000;
+    circbuf::SpscCircularBuffer<int, 64> queue;
+    std::thread producer{[&queue] {
+        int next = 0;
+        while (next < count)
+        {
+            const auto slots = queue.claim(20);
+            std::size_t written{};
+            for (const auto segment : slots)
+            {
+                for (auto& slot : segment)
+                {
+                    if (next < count)
+                    {
+                        slot = next++;
+                        ++written;
+                    }
+                }
+            }
+            queue.publish(written);
+            if (written == 0)
+            {
+                std::this_thread::yield();
+            }
+        }
+    }};
+    int expected = 0;
+    bool ordered = true;
+    while (expected < count)
+    {
+        const auto batch = queue.peek_batch(32);
+        std::size_t read{};
+        for (const auto segment : batch)
+        {
+            for (const auto value : segment)
+            {
+                ordered = ordered && value == expected;
+                ++expected;
+                ++read;
+            }
+        }
+        queue.consume(read);
+        if (read == 0)
+        {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    REQUIRE(ordered);
+    REQUIRE(queue.empty());
+}
+
+TEST_CASE("test_spsc_size_from_third_thread")
+{
+    constexpr int count = 10000;
+    circbuf::SpscCircularBuffer<int, 8> queue;
+    std::atomic<bool> done{false};
+    bool bounded = true;
+    std::thread observer{[&] {
+        while (!done.load())
+        {
+            bounded = bounded && queue.size() <= queue.max_size();
+            std::this_thread::yield();
+        }
+    }};
+    std::thread consumer{[&queue] {
+        int received = 0;
+        while (received < count)
+        {
+            if (queue.try_pop())
+            {
+                ++received;
+            }
+            else
+            {
+                std::this_thread::yield();
+            }
+        }
+    }};
+    for (int i = 0; i < count;)
+    {
+        if (queue.try_push(i))
+        {
+            ++i;
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+    consumer.join();
+    done = true;
+    observer.join();
+    REQUIRE(bounded);
+    REQUIRE(queue.empty());
+}
@@ -0,0 +1,124 @@
+#include "catch_amalgamated.hpp"
+#include "circbuf.h"
+#include "circbuf_statistics.h"
+
+#include <cstddef>
+#include <cstring>
+#include <span>
+#include <vector>
+
+namespace
+{
+
+struct FakeClock
+{
+    using rep = long long;
+    using period = std::nano;
+    using duration = std::chrono::duration<rep, period>;
+    using time_point = std::chrono::time_point<FakeClock>;
+    static constexpr bool is_steady = true;
+
+    static time_point
+    now() noexcept
+    {
+        return time_point{duration{ticks}};
+    }
+
+    static inline rep ticks{};
+};
+
+using FakeStatistics = circbuf::BasicStatistics<FakeClock>;
+
+} // namespace
+
+TEST_CASE("test_statistics_counters")
+{
+    circbuf::CircularBuffer<int, 3, circbuf::Statistics> cb;
+    cb.push_back(1);
+    cb.push_back(2);
+    cb.emplace_back(3);
+    cb.push_back(4);
+    cb.push_back(5);
+    cb.pop_front();
+    const auto& stats = cb.policy();
+    REQUIRE(5 == stats.pushes());
+    REQUIRE(1 == stats.pops());
+    REQUIRE(2 == stats.overwrites());
+    REQUIRE(3 == stats.high_water_mark());
+    cb.policy().reset();
+    REQUIRE(0 == stats.pushes());
+    REQUIRE(0 == stats.pops());
+    REQUIRE(0 == stats.overwrites());
+    REQUIRE(0 == stats.high_water_mark());
+}
+
+TEST_CASE("test_statistics_time_full")
+{
+    FakeClock::ticks = 0;
+    circbuf::CircularBuffer<int, 2, FakeStatistics> cb;
+    cb.push_back(1);
+    FakeClock::ticks = 10;
+    cb.push_back(2);
+    REQUIRE(0 == cb.policy().time_full().count());
+    FakeClock::ticks = 25;
+    cb.push_back(3);
+    REQUIRE(15 == cb.policy().time_full().count());
+    FakeClock::ticks = 30;
+    cb.pop_front();
+    FakeClock::ticks = 100;
+    REQUIRE(20 == cb.policy().time_full().count());
+    cb.push_back(4);
+    FakeClock::ticks = 110;
+    cb.clear();
+    FakeClock::ticks = 200;
+    REQUIRE(30 == cb.policy().time_full().count());
+}
+
+TEST_CASE("test_statistics_copied_with_buffer")
+{
+    circbuf::CircularBuffer<int, 2, circbuf::Statistics> cb;
+    cb.push_back(1);
+    cb.push_back(2);
+    cb.push_back(3);
+    auto cb2 = cb;
+    REQUIRE(3 == cb2.policy().pushes());
+    REQUIRE(1 == cb2.policy().overwrites());
+    REQUIRE(cb == cb2);
+    circbuf::CircularBuffer<int, 2> plain;
+    plain.push_back(2);
+    plain.push_back(3);
+    REQUIRE(cb == plain);
+}
+
+TEST_CASE("test_statistics_after_deserialize")
+{
+    circbuf::CircularBuffer<int, 3> source;
+    for (int i = 0; i < 3; ++i)
+    {
+        source.push_back(i);
+    }
+    std::vector<std::byte> bytes;
+    source.serialize([&bytes](const std::span<const std::byte> data) {
+        bytes.insert(bytes.end(), data.begin(), data.end());
+    });
+
+    FakeClock::ticks = 0;
+    circbuf::CircularBuffer<int, 3, FakeStatistics> cb;
+    cb.push_back(7);
+    cb.policy().reset();
+    std::size_t position{};
+    REQUIRE(cb.deserialize([&](const std::span<std::byte> data) {
+        std::memcpy(data.data(), bytes.data() + position, data.size());
+        position += data.size();
+        return true;
+    }));
+    REQUIRE(3 == cb.size());
+    const auto& stats = cb.policy();
+    REQUIRE(3 == stats.pushes());
+    REQUIRE(0 == stats.overwrites());
+    REQUIRE(3 == stats.high_water_mark());
+    FakeClock::ticks = 10;
+    REQUIRE(10 == stats.time_full().count());
+    cb.push_back(3);
+    REQUIRE(1 == stats.overwrites());
+}
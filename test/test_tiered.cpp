@@ -0,0 +1,92 @@
+#include "catch_amalgamated.hpp"
+#include "circbuf_tiered.h"
+
+#include <cstdint>
+#include <vector>
+
+TEST_CASE("test_tiered_hot_only")
+{
+    circbuf::TieredCircularBuffer<int, 4, 2> buffer;
+    REQUIRE(buffer.empty());
+    REQUIRE(buffer.rbegin() == buffer.rend());
+    buffer.push_back(1);
+    buffer.push_back(2);
+    REQUIRE(2 == buffer.size());
+    REQUIRE(2 == buffer.back());
+    REQUIRE(buffer.cold().empty());
+    std::vector<int> values;
+    for (auto it = buffer.rbegin(); it != buffer.rend(); ++it)
+    {
+        REQUIRE(it.hot());
+        values.push_back(*it);
+    }
+    REQUIRE(std::vector<int>{2, 1} == values);
+}
+
+TEST_CASE("test_tiered_spills_to_cold")
+{
+    circbuf::TieredCircularBuffer<std::int64_t, 8, 4, 64, 16> buffer;
+    for (std::int64_t i = 0; i < 20; ++i)
+    {
+        buffer.push_back(i * 3);
+    }
+    REQUIRE(8 == buffer.hot().size());
+    REQUIRE(12 == buffer.cold().size());
+    REQUIRE(20 == buffer.size());
+    REQUIRE(57 == buffer.back());
+    std::vector<std::int64_t> values;
+    std::size_t hot{};
+    for (auto it = buffer.rbegin(); it != buffer.rend(); ++it)
+    {
+        hot += it.hot() ? 1 : 0;
+        values.push_back(*it);
+    }
+    REQUIRE(8 == hot);
+    REQUIRE(20 == values.size());
+    for (std::size_t i = 0; i < values.size(); ++i)
+    {
+        REQUIRE(static_cast<std::int64_t>(19 - i) * 3 == values[i]);
+    }
+}
+
+TEST_CASE("test_tiered_cold_evicts_blocks")
+{
+    circbuf::TieredCircularBuffer<double, 16, 2, 64, 8> buffer;
+    for (int i = 0; i < 1000; ++i)
+    {
+        buffer.push_back(i * 0.25);
+    }
+    REQUIRE(16 == buffer.hot().size());
+    REQUIRE(buffer.cold().size() <= 16);
+    // the newest values survive in both tiers and stay contiguous
+    double expected = 999 * 0.25;
+    for (auto it = buffer.rbegin(); it != buffer.rend(); ++it)
+    {
+        REQUIRE(expected == *it);
+        expected -= 0.25;
+    }
+    REQUIRE(expected == (999.0 - static_cast<double>(buffer.size())) * 0.25);
+    buffer.clear();
+    REQUIRE(0 == buffer.size());
+}
+
+TEST_CASE("test_tiered_copies_spill_into_their_own_cold_tier")
+{
+    circbuf::TieredCircularBuffer<int, 2, 2> buffer;
+    buffer.push_back(1);
+    buffer.push_back(2);
+    auto copy = buffer;
+    copy.push_back(3);
+    REQUIRE(buffer.cold().empty());
+    REQUIRE(1 == copy.cold().size());
+    REQUIRE(1 == copy.cold().front());
+
+    buffer = copy;
+    copy.push_back(4);
+    buffer.push_back(5);
+    REQUIRE(2 == copy.cold().size());
+    REQUIRE(2 == buffer.cold().size());
+    REQUIRE(2 == copy.cold().back());
+    REQUIRE(2 == buffer.cold().back());
+    REQUIRE(5 == buffer.back());
+}
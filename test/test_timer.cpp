@@ -0,0 +1,237 @@
+#include "catch_amalgamated.hpp"
+#include "circbuf_timer.h"
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+using Wheel = circbuf::TimingWheel<int, 4, 3, 32>;
+
+// Advances one tick at a time and records the tick each value fired at.
+template <typename WheelType>
+std::vector<std::pair<std::uint64_t, int>>
+run(WheelType& wheel, const std::uint64_t ticks)
+{
+    std::vector<std::pair<std::uint64_t, int>> fired;
+    for (std::uint64_t tick = 0; tick < ticks; ++tick)
+    {
+        wheel.advance(1, [&](const int value) {
+            fired.emplace_back(wheel.now(), value);
+        });
+    }
+    return fired;
+}
+
+} // namespace
+
+TEST_CASE("test_timer_fires_at_expiry")
+{
+    Wheel wheel;
+    REQUIRE(Wheel::horizon() == 64);
+    REQUIRE(wheel.schedule(3, 1));
+    REQUIRE(wheel.schedule(1, 2));
+    REQUIRE(wheel.schedule(0, 3));
+    REQUIRE(wheel.schedule(17, 4));
+    REQUIRE(wheel.schedule(63, 5));
+    REQUIRE(wheel.size() == 5);
+    REQUIRE(run(wheel, 70) ==
+            std::vector<std::pair<std::uint64_t, int>>{
+                {1, 3}, {1, 2}, {3, 1}, {17, 4}, {63, 5}});
+    REQUIRE(wheel.empty());
+    REQUIRE(wheel.now() == 70);
+}
+
+TEST_CASE("test_timer_beyond_horizon")
+{
+    Wheel wheel;
+    wheel.advance(5, [](int) {});
+    const auto id = wheel.schedule(200, 1);
+    REQUIRE(wheel.expiry(*id) == 205);
+    REQUIRE(wheel.schedule(64, 2));
+    REQUIRE(run(wheel, 300) == std::vector<std::pair<std::uint64_t, int>>{
+                                   {69, 2}, {205, 1}});
+}
+
+TEST_CASE("test_timer_beyond_horizon_with_one_level")
+{
+    circbuf::TimingWheel<int, 16, 1, 8> wheel;
+    REQUIRE(wheel.horizon() == 16);
+    REQUIRE(wheel.schedule(3506, 1));
+    REQUIRE(wheel.schedule(16, 2));
+    REQUIRE(wheel.schedule(15, 3));
+    REQUIRE(run(wheel, 4000) == std::vector<std::pair<std::uint64_t, int>>{
+                                    {15, 3}, {16, 2}, {3506, 1}});
+}
+
+namespace
+{
+
+struct ThrowingMove
+{
+    explicit ThrowingMove(const bool fail)
+        : fail{fail}
+    {
+    }
+
+    ThrowingMove(ThrowingMove&& other)
+        : fail{other.fail}
+    {
+        if (fail)
+        {
+            throw std::runtime_error{"move"};
+        }
+    }
+
+    bool fail;
+};
+
+} // namespace
+
+TEST_CASE("test_timer_schedule_keeps_slot_on_throw")
+{
+    circbuf::TimingWheel<ThrowingMove, 4, 2, 2> wheel;
+    REQUIRE_THROWS_AS(wheel.schedule(1, ThrowingMove{true}),
+                      std::runtime_error);
+    REQUIRE(wheel.empty());
+    REQUIRE(wheel.schedule(1, ThrowingMove{false}));
+    REQUIRE(wheel.schedule(2, ThrowingMove{false}));
+    REQUIRE(wheel.full());
+    REQUIRE(wheel.advance(2, [](ThrowingMove) {}) == 2);
+    REQUIRE(wheel.schedule(1, ThrowingMove{false}));
+    REQUIRE(wheel.schedule(1, ThrowingMove{false}));
+}
+
+TEST_CASE("test_timer_cancel")
+{
+    Wheel wheel;
+    const auto a = *wheel.schedule(10, 1);
+    const auto b = *wheel.schedule(10, 2);
+    const auto c = *wheel.schedule(40, 3);
+    REQUIRE(wheel.cancel(b));
+    REQUIRE(!wheel.cancel(b));
+    REQUIRE(!wheel.pending(b));
+    REQUIRE(wheel.pending(a));
+    REQUIRE(wheel.cancel(c));
+    REQUIRE(wheel.size() == 1);
+
+    // The freed slot is reused under a new generation.
+    const auto d = *wheel.schedule(5, 4);
+    REQUIRE(d.index == c.index);
+    REQUIRE(!wheel.cancel(c));
+    REQUIRE(wheel.pending(d));
+
+    REQUIRE(run(wheel, 50) == std::vector<std::pair<std::uint64_t, int>>{
+                                  {5, 4}, {10, 1}});
+    REQUIRE(!wheel.pending(a));
+    REQUIRE(!wheel.cancel(a));
+}
+
+TEST_CASE("test_timer_full")
+{
+    circbuf::TimingWheel<int, 4, 2, 2> wheel;
+    REQUIRE(wheel.schedule(1, 1));
+    REQUIRE(wheel.schedule(2, 2));
+    REQUIRE(wheel.full());
+    REQUIRE(!wheel.schedule(3, 3));
+    REQUIRE(wheel.advance(1, [](int) {}) == 1);
+    REQUIRE(wheel.schedule(3, 3));
+    wheel.clear();
+    REQUIRE(wheel.empty());
+    REQUIRE(wheel.advance(10, [](int) {}) == 0);
+}
+
+TEST_CASE("test_timer_callback_reschedules")
+{
+    circbuf::TimingWheel<std::string, 8, 2, 4> wheel;
+    std::vector<std::pair<std::uint64_t, std::string>> fired;
+    wheel.schedule(2, "tick");
+    wheel.advance_to(20, [&](std::string value) {
+        fired.emplace_back(wheel.now(), value);
+        if (fired.size() < 3)
+        {
+            wheel.schedule(5, std::move(value));
+        }
+    });
+    REQUIRE(fired == std::vector<std::pair<std::uint64_t, std::string>>{
+                         {2, "tick"}, {7, "tick"}, {12, "tick"}});
+    REQUIRE(wheel.now() == 20);
+}
+
+TEST_CASE("test_timer_move_only_values")
+{
+    circbuf::TimingWheel<std::unique_ptr<int>, 4, 2, 4> wheel;
+    wheel.schedule(3, std::make_unique<int>(42));
+    int result = 0;
+    wheel.advance(3, [&](std::unique_ptr<int> value) { result = *value; });
+    REQUIRE(result == 42);
+}
+
+TEST_CASE("test_timer_against_reference")
+{
+    circbuf::TimingWheel<int, 8, 3, 256> wheel;
+    std::multimap<std::uint64_t, int> expected;
+    std::map<int, circbuf::TimerId> ids;
+    std::mt19937 engine{7};
+    int next = 0;
+    for (int step = 0; step < 5000; ++step)
+    {
+        const auto action = engine() % 4;
+        if (action < 2 && !wheel.full())
+        {
+            const std::uint64_t delay = engine() % 700;
+            const auto id = wheel.schedule(delay, next);
+            REQUIRE(id);
+            expected.emplace(wheel.now() + (delay == 0 ? 1 : delay), next);
+            ids.emplace(next, *id);
+            ++next;
+        }
+        else if (action == 2 && !ids.empty())
+        {
+            auto it = ids.begin();
+            std::advance(it, static_cast<long>(engine() % ids.size()));
+            REQUIRE(wheel.cancel(it->second));
+            for (auto e = expected.begin(); e != expected.end(); ++e)
+            {
+                if (e->second == it->first)
+                {
+                    expected.erase(e);
+                    break;
+                }
+            }
+            ids.erase(it);
+        }
+        else
+        {
+            const std::uint64_t ticks = engine() % 20;
+            wheel.advance(ticks, [&](const int value) {
+                const auto e = expected.begin();
+                REQUIRE(e != expected.end());
+                REQUIRE(e->first == wheel.now());
+                const auto range = expected.equal_range(wheel.now());
+                bool found = false;
+                for (auto it = range.first; it != range.second; ++it)
+                {
+                    if (it->second == value)
+                    {
+                        expected.erase(it);
+                        found = true;
+                        break;
+                    }
+                }
+                REQUIRE(found);
+                ids.erase(value);
+            });
+            REQUIRE((expected.empty() ||
+                     expected.begin()->first > wheel.now()));
+        }
+        REQUIRE(wheel.size() == expected.size());
+    }
+}
@@ -0,0 +1,108 @@
+#include "catch_amalgamated.hpp"
+#include "circbuf_window.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+struct Sample
+{
+    long time;
+    std::string name;
+};
+
+struct SampleTime
+{
+    long
+    operator()(const Sample& sample) const
+    {
+        return sample.time;
+    }
+};
+
+std::vector<long>
+times(const circbuf::TimeWindowBuffer<Sample, 5, SampleTime>& buf)
+{
+    std::vector<long> result;
+    for (const auto& sample : buf)
+    {
+        result.push_back(sample.time);
+    }
+    return result;
+}
+
+consteval auto
+consteval_window_expire()
+{
+    auto identity = [](const int value) { return value; };
+    circbuf::TimeWindowBuffer<int, 8, decltype(identity)> buf{10, identity};
+    for (int i = 0; i < 30; i += 3)
+    {
+        buf.push_back(i);
+    }
+    return buf.size();
+}
+
+// 27 keeps 18, 21, 24 and 27
+static_assert(4 == consteval_window_expire());
+
+} // namespace
+
+TEST_CASE("test_window_expires_on_push")
+{
+    circbuf::TimeWindowBuffer<Sample, 5, SampleTime> buf{10};
+    REQUIRE(10 == buf.window());
+    buf.push_back(Sample{1, "a"});
+    buf.push_back(Sample{5, "b"});
+    buf.push_back(Sample{9, "c"});
+    REQUIRE(std::vector<long>{1, 5, 9} == times(buf));
+    buf.push_back(Sample{12, "d"});
+    REQUIRE(std::vector<long>{5, 9, 12} == times(buf));
+    buf.push_back(Sample{30, "e"});
+    REQUIRE(std::vector<long>{30} == times(buf));
+    REQUIRE("e" == buf.front().name);
+}
+
+TEST_CASE("test_window_hard_cap")
+{
+    circbuf::TimeWindowBuffer<Sample, 5, SampleTime> buf{100};
+    for (long i = 0; i < 8; ++i)
+    {
+        buf.push_back(Sample{i, std::to_string(i)});
+    }
+    REQUIRE(buf.full());
+    REQUIRE(std::vector<long>{3, 4, 5, 6, 7} == times(buf));
+    REQUIRE(0 == buf.expire(102));
+    REQUIRE(1 == buf.expire(103));
+    REQUIRE(std::vector<long>{4, 5, 6, 7} == times(buf));
+    REQUIRE(4 == buf.expire(1000));
+    REQUIRE(buf.empty());
+}
+
+TEST_CASE("test_window_with_chrono")
+{
+    using namespace std::chrono_literals;
+    using Clock = std::chrono::steady_clock;
+    struct Event
+    {
+        Clock::time_point time;
+        int id;
+    };
+    const auto timestamp = [](const Event& event) { return event.time; };
+    circbuf::TimeWindowBuffer<Event, 16, decltype(timestamp)> buf{5s,
+                                                                   timestamp};
+    const Clock::time_point start{};
+    for (int i = 0; i < 10; ++i)
+    {
+        buf.push_back(Event{start + std::chrono::seconds{i}, i});
+    }
+    REQUIRE(5 == buf.size());
+    REQUIRE(5 == buf.front().id);
+    REQUIRE(9 == buf.back().id);
+    REQUIRE(2 == buf.expire(start + 11s));
+    REQUIRE(7 == buf.front().id);
+    REQUIRE(9 == buf.rbegin()->id);
+}